@@ -0,0 +1,179 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "linked-list.h"
+#include "typed-list.h"
+
+/*
+ * The callback list merge and heap against their typed-list.h versions, on
+ * records shaped like Student_t. `make bench` builds it with the same flags
+ * as the program, so the numbers are those of the shipped binary. Each case
+ * reports the best of BENCH_RUNS runs.
+ */
+
+#define BENCH_RUNS 5
+#define MERGE_COUNT 500000
+#define HEAP_WAYS 64
+#define HEAP_POPS 1000000
+
+typedef struct Item
+{
+    ListNode_t node;
+    uint32_t id;
+} Item_t;
+
+DEFINE_TYPED_MERGE(item, Item_t, id)
+DEFINE_TYPED_HEAP(item, Item_t, id)
+
+static uint32_t Seed = 12345;
+
+static uint32_t next_random()
+{
+    Seed = Seed * 1103515245 + 12345;
+    return Seed >> 8;
+}
+
+static double now()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int32_t cmp_item(ListNode_t *a, ListNode_t *b)
+{
+    uint32_t x = ((Item_t *)a)->id;
+    uint32_t y = ((Item_t *)b)->id;
+
+    return (x > y) - (x < y);
+}
+
+/* the callback heap the student iterator used before the typed one */
+static void generic_min_heapify(Item_t *heap[], int size, int i,
+                                int32_t (*cmp_func)(ListNode_t *, ListNode_t *))
+{
+    int smallest = i;
+    int left = 2 * i + 1;
+    int right = 2 * i + 2;
+    Item_t *temp = NULL;
+
+    if (left < size && cmp_func((ListNode_t *)heap[left], (ListNode_t *)heap[smallest]) < 0)
+    {
+        smallest = left;
+    }
+    if (right < size && cmp_func((ListNode_t *)heap[right], (ListNode_t *)heap[smallest]) < 0)
+    {
+        smallest = right;
+    }
+    if (smallest != i)
+    {
+        temp = heap[i];
+        heap[i] = heap[smallest];
+        heap[smallest] = temp;
+        generic_min_heapify(heap, size, smallest, cmp_func);
+    }
+}
+
+static void fill_random(Item_t *items, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        items[i].id = next_random();
+    }
+}
+
+/* `count` items with ascending IDs, every `step`-th ID starting at `first` */
+static Item_t *fill_sorted(Item_t *items, size_t count, uint32_t first, uint32_t step)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        items[i].id = first + (uint32_t)i * step;
+        items[i].node.prev = (i > 0) ? &items[i - 1].node : NULL;
+        items[i].node.next = (i + 1 < count) ? &items[i + 1].node : NULL;
+    }
+    return items;
+}
+
+static double bench_merge(Item_t *items, bool_t typed)
+{
+    Item_t *head1 = fill_sorted(items, MERGE_COUNT, 0, 2);
+    Item_t *head2 = fill_sorted(items + MERGE_COUNT, MERGE_COUNT, 1, 2);
+    double start = now();
+
+    if (typed == true)
+    {
+        item_merge_sorted(&head1, head2);
+    }
+    else
+    {
+        merge_sorted((ListNode_t **)&head1, &head2->node, &cmp_item);
+    }
+    return now() - start;
+}
+
+/* pops the root of a HEAP_WAYS-way merge heap and advances it, as the student iterator does */
+static double bench_heap(Item_t *items, bool_t typed)
+{
+    Item_t *heap[HEAP_WAYS];
+    double start = 0;
+
+    fill_random(items, HEAP_WAYS);
+    for (int i = 0; i < HEAP_WAYS; i++)
+    {
+        heap[i] = &items[i];
+    }
+    item_build_min_heap(heap, HEAP_WAYS);
+
+    start = now();
+    for (size_t i = 0; i < HEAP_POPS; i++)
+    {
+        heap[0]->id += next_random() >> 12;
+        if (typed == true)
+        {
+            item_min_heapify(heap, HEAP_WAYS, 0);
+        }
+        else
+        {
+            generic_min_heapify(heap, HEAP_WAYS, 0, &cmp_item);
+        }
+    }
+    return now() - start;
+}
+
+static void report(const char *name, Item_t *items, double (*bench)(Item_t *, bool_t))
+{
+    double best[2] = {1e9, 1e9};
+    double elapsed = 0;
+
+    for (int run = 0; run < BENCH_RUNS; run++)
+    {
+        for (int typed = 0; typed < 2; typed++)
+        {
+            Seed = 12345;
+            elapsed = bench(items, (bool_t)typed);
+            best[typed] = (elapsed < best[typed]) ? elapsed : best[typed];
+        }
+    }
+    printf("%-28s generic %8.4fs  typed %8.4fs  %+6.1f%%\n", name, best[0], best[1],
+           (best[1] - best[0]) * 100.0 / best[0]);
+}
+
+int main()
+{
+    Item_t *items = (Item_t *)malloc(2 * MERGE_COUNT * sizeof(Item_t));
+
+    if (items == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    report("merge_sorted, 2 x 500000", items, &bench_merge);
+    report("heap sift, 1M pops of 64", items, &bench_heap);
+
+    free(items);
+    return 0;
+}
@@ -0,0 +1,23 @@
+#ifndef __COLUMN_STATS_H__
+#define __COLUMN_STATS_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+/* summary of a column of marks, min and max are only meaningful when count > 0 */
+typedef struct ColumnStats
+{
+    uint64_t count;
+    uint64_t sum;
+    uint64_t sum_squares;
+    uint64_t passed;
+    uint8_t min;
+    uint8_t max;
+} ColumnStats_t;
+
+void column_stats(const uint8_t *marks, size_t count, uint8_t pass_mark, ColumnStats_t *stats);
+const char *column_stats_kernel();
+
+#endif /* __COLUMN_STATS_H__ */
@@ -5,6 +5,9 @@
 #include <stdint.h>
 
 /* #define USE_UNICODE */
+#define USE_COMPACT_SNAPSHOT
+#define USE_PARALLEL_LOAD
+#define USE_PARALLEL_REPORTS
 
 #define DEPT_NAME_SIZE 20
 #define INT_DEPT_LENGTH 10
@@ -13,6 +16,10 @@
 #define INT_STUDENT_LENGTH 3
 
 #define MAX_GRADE 100
+#define SUBJECT_COUNT 3 /* English, Math, History */
+#define SUBJECT_TOTAL SUBJECT_COUNT /* subject index standing for the total */
+#define MAX_TOTAL (SUBJECT_COUNT * MAX_GRADE)
+#define PASS_MARK 40
 #define INT_GRADE_LENGTH 3
 
 #define WINDOW_MIN_WIDTH 30
@@ -26,11 +33,13 @@
     #define PIPE2 "│"
     #define HIGHLIGHT_START "\x1b[48;5;46m\x1b[30m"
     #define HIGHLIGHT_RED "\x1b[41m\x1b[37m"
+    #define BAR "█"
 #else
     #define PIPE "|"
     #define PIPE2 "|"
     #define HIGHLIGHT_START "\x1b[7m"
     #define HIGHLIGHT_RED ""
+    #define BAR "#"
 #endif
 #define HIGHLIGHT_END "\x1b[0m"
 
@@ -44,6 +53,7 @@ extern char **Menu_Options;
 
 void cleanup_and_exit();
 char *string_alloc(const char *literal, size_t max_size);
+void string_copy(char *dest, const char *src, size_t max_size);
 void print_centered(char *before, char *str, size_t max_len, char *after);
 int32_t compare_uint32(uint32_t a, uint32_t b);
 int32_t rollover(int32_t current_val, int32_t max_val, int32_t increment);
@@ -0,0 +1,109 @@
+#ifndef __DATA_FILE_H__
+#define __DATA_FILE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+/* version 2 extends the checksum over the header; version 1 files only cover the payload */
+#define DATA_FILE_VERSION 2
+#define DEPT_FILE_MAGIC 0x54504453U    /* "SDPT" */
+#define STUDENT_FILE_MAGIC 0x55545353U /* "SSTU" */
+#define GRADE_FILE_MAGIC 0x44524753U   /* "SGRD" */
+#define JOURNAL_FILE_MAGIC 0x4C4E4A53U /* "SJNL" */
+
+/* records use delta-varint IDs and packed fields instead of fixed-width ones */
+#define DATA_FLAG_COMPACT 0x0001U
+#define DATA_FLAGS_KNOWN DATA_FLAG_COMPACT
+
+#ifdef USE_COMPACT_SNAPSHOT
+    #define SNAPSHOT_FLAGS DATA_FLAG_COMPACT
+#else
+    #define SNAPSHOT_FLAGS 0
+#endif
+
+typedef struct DataHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t flags;
+    uint32_t record_count;
+    uint32_t checksum;
+} DataHeader_t;
+
+typedef enum DataHeaderStatus
+{
+    DATA_HEADER_OK = 0,
+    DATA_HEADER_LEGACY,
+    DATA_HEADER_BAD_VERSION,
+    DATA_HEADER_BAD_CHECKSUM,
+    DATA_HEADER_BAD_COUNT
+} DataHeaderStatus_t;
+
+typedef struct DataReader
+{
+    const uint8_t *data;
+    size_t size;
+    size_t pos;
+    bool_t mapped;
+    DataHeader_t header;
+} DataReader_t;
+
+typedef struct DataWriter
+{
+    int fd;
+    char *filename;
+    char *temp_filename;
+    uint8_t *buffer;
+    size_t used;
+    bool_t failed;
+    uint32_t magic;
+    uint16_t flags;
+    uint32_t checksum;
+} DataWriter_t;
+
+/*
+ * Records parsed from one snapshot file and waiting to be linked into the
+ * in-memory tables. Parsing a file touches nothing but its ParsedTable_t,
+ * so the three files can be parsed on separate threads; linking and error
+ * reporting happen afterwards on the main thread.
+ */
+typedef struct ParsedTable
+{
+    const char *filename;
+    const char *error; /* first error met while parsing, NULL if none */
+    DataReader_t reader;
+    uint8_t *records;
+    uint32_t *keys; /* lookup key of each record, used by the link phase */
+    size_t record_size;
+    size_t count;
+    size_t capacity;
+} ParsedTable_t;
+
+bool_t data_reader_open(DataReader_t *reader, const char *filename);
+DataHeaderStatus_t data_reader_header(DataReader_t *reader, uint32_t magic,
+                                      size_t min_record_size);
+const char *data_header_error(DataHeaderStatus_t status);
+uint32_t data_checksum(const void *data, size_t size);
+const uint8_t *data_reader_take(DataReader_t *reader, size_t size);
+bool_t data_reader_read(DataReader_t *reader, void *dest, size_t size);
+bool_t data_reader_read_varint(DataReader_t *reader, uint32_t *value);
+size_t data_reader_remaining(const DataReader_t *reader);
+void data_reader_close(DataReader_t *reader);
+
+bool_t data_writer_open(DataWriter_t *writer, const char *filename, uint32_t magic,
+                        uint16_t flags);
+void data_writer_put(DataWriter_t *writer, const void *data, size_t size);
+void data_writer_put_varint(DataWriter_t *writer, uint32_t value);
+bool_t data_writer_commit(DataWriter_t *writer, uint32_t record_count);
+void data_writer_abort(DataWriter_t *writer);
+
+bool_t parsed_table_open(ParsedTable_t *table, const char *filename, uint32_t magic,
+                         size_t record_size, size_t min_stored_size);
+bool_t parsed_table_reserve(ParsedTable_t *table, size_t capacity);
+void *parsed_table_add(ParsedTable_t *table, uint32_t key);
+void *parsed_table_record(const ParsedTable_t *table, size_t index);
+void parsed_table_free(ParsedTable_t *table);
+
+#endif /* __DATA_FILE_H__ */
@@ -3,19 +3,37 @@
 
 #include <stdint.h>
 
+#include "common.h"
 #include "linked-list.h"
 
+/* dept_id of a student without a department, also used in the data files */
+#define DEPT_NONE UINT32_MAX
+
 typedef struct Student Student_t;
 
+/* running totals over the students of a department, kept by dept_stats_apply() */
+typedef struct DeptStats
+{
+    uint32_t headcount;
+    uint32_t male;
+    uint32_t female;
+    uint32_t graded;
+    uint64_t sum[SUBJECT_COUNT];         /* English, Math, History */
+    uint64_t sum_squares[SUBJECT_COUNT];
+} DeptStats_t;
+
 typedef struct Dept
 {
     ListNode_t node;
     uint32_t id;
-    char *name;
+    char name[DEPT_NAME_SIZE];
     Student_t *students;
+    SkipIndex_t student_lanes; /* express lanes over `students` */
+    DeptStats_t stats;
 } Dept_t;
 
 extern Dept_t *Dept_Head;
+extern uint32_t Dept_Generation;
 
 void print_dept();
 void dept_from_user();
@@ -23,7 +41,13 @@ void cleanup_dept();
 void delete_dept_from_user();
 void update_dept_from_user();
 int32_t match_dept(ListNode_t *node, uint32_t id);
-void save_depts(const char *filename);
+Dept_t *search_dept(uint32_t id);
+Dept_t *dept_put(uint32_t id, const char *name);
+void dept_remove(uint32_t id);
+bool_t save_depts(const char *filename);
+void parse_depts(const char *filename);
+void link_depts();
 void load_depts(const char *filename);
+void dept_stats_apply(Dept_t *dept, const Student_t *student, int32_t delta);
 
 #endif /* __DEPT_H__ */
\ No newline at end of file
@@ -0,0 +1,15 @@
+#ifndef __FENWICK_H__
+#define __FENWICK_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+/* slots a tree over the values 0..max_value needs */
+#define FENWICK_SIZE(max_value) ((max_value) + 2)
+
+void fenwick_add(uint32_t tree[], size_t size, uint32_t value, int32_t delta);
+uint32_t fenwick_count_upto(const uint32_t tree[], size_t size, uint32_t value);
+
+#endif /* __FENWICK_H__ */
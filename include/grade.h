@@ -1,24 +1,50 @@
 #ifndef __GRADE_H__
 #define __GRADE_H__
 
+#include <stdint.h>
+
+#include "common.h"
 #include "linked-list.h"
 
+/* grade_row of a student without grades */
+#define GRADE_NONE UINT32_MAX
+
 typedef struct Student Student_t;
 
-typedef struct Grade
+/*
+ * Grades are stored column-wise: row `i` of every column belongs to
+ * `owner[i]`, whose grade_row is `i`. Rows are kept dense, deleting a grade
+ * moves the last row into the hole, so reports can stream over the marks
+ * without visiting the students.
+ */
+typedef struct GradeTable
 {
-    Student_t *student;
-    uint8_t english;
-    uint8_t math;
-    uint8_t history;
-} Grade_t;
+    uint8_t *english;
+    uint8_t *math;
+    uint8_t *history;
+    Student_t **owner;
+    uint32_t count;
+    uint32_t capacity;
+} GradeTable_t;
+
+extern GradeTable_t Grades;
+extern uint32_t Grade_Generation;
 
 void grade_from_user();
 void delete_grade_from_user();
 void update_grade_from_user();
-void delete_grade(Grade_t *grade);
+void delete_grade(Student_t *student);
+bool_t grade_put(uint32_t student_id, uint8_t english, uint8_t math, uint8_t history);
+void grade_remove(uint32_t student_id);
+void cleanup_grade();
 void print_grades();
-void save_grades(const char *filename);
+void print_grade_table(Student_t **students, size_t count);
+bool_t save_grades(const char *filename);
+void parse_grades(const char *filename);
+void link_grades();
 void load_grades(const char *filename);
+uint32_t grade_score(uint32_t row, int subject);
+uint32_t grades_at_most(int subject, uint32_t score);
+uint32_t grades_at_least(int subject, uint32_t score);
 
-#endif /* __GRADE_H__ */
\ No newline at end of file
+#endif /* __GRADE_H__ */
@@ -0,0 +1,23 @@
+#ifndef __HASH_INDEX_H__
+#define __HASH_INDEX_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+typedef struct HashIndex
+{
+    uint32_t *keys;
+    void **values;
+    size_t capacity;
+    size_t count;
+} HashIndex_t;
+
+bool_t hash_index_reserve(HashIndex_t *index, size_t count);
+bool_t hash_index_insert(HashIndex_t *index, uint32_t key, void *value);
+void *hash_index_find(const HashIndex_t *index, uint32_t key);
+void hash_index_remove(HashIndex_t *index, uint32_t key);
+void hash_index_free(HashIndex_t *index);
+
+#endif /* __HASH_INDEX_H__ */
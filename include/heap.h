@@ -1,10 +1,66 @@
 #ifndef __HEAP_H__
 #define __HEAP_H__
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+/* list cursors an iterator holds without allocating */
+#define STUDENT_ITER_INLINE 16
+
 typedef struct Student Student_t;
 
-void sorted_student_init();
-Student_t *sorted_student_next();
-void sorted_student_free();
+typedef bool_t (*StudentFilter_t)(const Student_t *student, void *context);
+
+/*
+ * Ordered traversal over all students, owned by the caller and usually
+ * kept on the stack. Iterators share no state, so any number may be open
+ * at once, on several threads, as long as nobody modifies the students
+ * meanwhile. An iterator must not be copied once initialised.
+ */
+typedef struct StudentIter
+{
+    Student_t **heap; /* min-heap of list cursors, NULL when walking the view */
+    int size;
+    size_t view_pos;
+    StudentFilter_t filter;
+    void *context;
+    Student_t *inline_heap[STUDENT_ITER_INLINE];
+} StudentIter_t;
+
+bool_t student_iter_init(StudentIter_t *iter, uint32_t start_id, StudentFilter_t filter,
+                         void *context);
+Student_t *student_iter_next(StudentIter_t *iter);
+void student_iter_free(StudentIter_t *iter);
+
+/* an item ranked by `key`, larger keys rank first */
+typedef struct HeapEntry
+{
+    uint64_t key;
+    void *item;
+} HeapEntry_t;
+
+/*
+ * Keeps the `capacity` entries with the largest keys seen so far, as a
+ * min-heap so the weakest of them is always at the root.
+ */
+typedef struct BoundedHeap
+{
+    HeapEntry_t *entries;
+    size_t size;
+    size_t capacity;
+} BoundedHeap_t;
+
+bool_t bounded_heap_init(BoundedHeap_t *heap, size_t capacity);
+void bounded_heap_offer(BoundedHeap_t *heap, uint64_t key, void *item);
+size_t bounded_heap_sort(BoundedHeap_t *heap);
+void bounded_heap_free(BoundedHeap_t *heap);
+
+bool_t sorted_students(Student_t ***students, size_t *count);
+void sorted_view_insert(Student_t *student);
+void sorted_view_remove(Student_t *student);
+void sorted_view_invalidate();
+void sorted_view_free();
 
-#endif /* __HEAP_H__ */
\ No newline at end of file
+#endif /* __HEAP_H__ */
@@ -0,0 +1,23 @@
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+#include <stdint.h>
+
+#include "common.h"
+
+typedef struct Dept Dept_t;
+typedef struct Student Student_t;
+
+void journal_dept_put(const Dept_t *dept);
+void journal_dept_delete(uint32_t id);
+void journal_student_put(const Student_t *student);
+void journal_student_delete(uint32_t id);
+void journal_grade_put(const Student_t *student);
+void journal_grade_delete(uint32_t student_id);
+bool_t journal_should_compact();
+bool_t journal_flush(const char *filename);
+void journal_reset(const char *filename);
+void journal_replay(const char *filename);
+void cleanup_journal();
+
+#endif /* __JOURNAL_H__ */
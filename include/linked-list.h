@@ -3,15 +3,54 @@
 
 #include <stdint.h>
 
+#include "pool.h"
+
+/* 4^SKIP_MAX_LEVEL nodes before the express lanes stop thinning out */
+#define SKIP_MAX_LEVEL 12
+#define SKIP_INDEX_INITIALIZER {{NULL}, 0, 0x9E3779B9, POOL_INITIALIZER(SkipLane_t, 64)}
+
 typedef struct ListNode
 {
     struct ListNode *prev;
     struct ListNode *next;
 } ListNode_t;
 
+/* one node of an express lane, `down` is NULL on the lowest lane */
+typedef struct SkipLane
+{
+    ListNode_t *node;
+    struct SkipLane *next;
+    struct SkipLane *down;
+} SkipLane_t;
+
+/*
+ * Express lanes over a sorted ListNode_t list. The list itself stays an
+ * ordinary doubly linked list reached through its own head pointer, so
+ * forward traversal is unchanged; the index only speeds up finding a
+ * position in it. lanes[0] is the densest lane.
+ */
+typedef struct SkipIndex
+{
+    SkipLane_t *lanes[SKIP_MAX_LEVEL];
+    int levels;
+    uint32_t seed;
+    Pool_t pool;
+} SkipIndex_t;
+
 void delete_node(ListNode_t **head, ListNode_t *node, void (*free_data)(ListNode_t *));
 ListNode_t *search_sorted(uint32_t search_item, int32_t (*match_func)(ListNode_t *, uint32_t), ListNode_t *head);
 void insert_sorted(ListNode_t **head, ListNode_t *new_node, int32_t (*cmp_func)(ListNode_t *, ListNode_t *));
+void insert_front(ListNode_t **head, ListNode_t *new_node);
 void merge_sorted(ListNode_t **head1, ListNode_t *head2, int32_t (*cmp_func)(ListNode_t *, ListNode_t *));
 
+void skip_index_init(SkipIndex_t *index);
+void skip_index_free(SkipIndex_t *index);
+void skip_index_build(SkipIndex_t *index, ListNode_t *head);
+void skip_insert(SkipIndex_t *index, ListNode_t **head, ListNode_t *new_node,
+                 int32_t (*cmp_func)(ListNode_t *, ListNode_t *));
+ListNode_t *skip_search(SkipIndex_t *index, ListNode_t *head, uint32_t search_item,
+                        int32_t (*match_func)(ListNode_t *, uint32_t));
+void skip_delete(SkipIndex_t *index, ListNode_t **head, ListNode_t *node,
+                 int32_t (*cmp_func)(ListNode_t *, ListNode_t *), void (*free_data)(ListNode_t *));
+
 #endif /* __LINKED_LIST_H__ */
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stddef.h>
+
+#include "common.h"
+
+#define POOL_ALIGN 8
+#define POOL_ITEM_SIZE(type) ((sizeof(type) + POOL_ALIGN - 1) / POOL_ALIGN * POOL_ALIGN)
+#define POOL_INITIALIZER(type, slab_items) {POOL_ITEM_SIZE(type), (slab_items), NULL, NULL, NULL, 0}
+
+typedef struct PoolSlab PoolSlab_t;
+
+typedef struct Pool
+{
+    size_t item_size;
+    size_t slab_items;
+    PoolSlab_t *slabs;
+    void *free_list;
+    char *unused;
+    size_t unused_count;
+} Pool_t;
+
+void *pool_alloc(Pool_t *pool);
+void pool_free(Pool_t *pool, void *item);
+bool_t pool_reserve(Pool_t *pool, size_t count);
+void pool_release(Pool_t *pool);
+
+#endif /* __POOL_H__ */
@@ -0,0 +1,12 @@
+#ifndef __REPORT_H__
+#define __REPORT_H__
+
+#include "common.h"
+
+void print_grade_ranking();
+void print_student_rank();
+void print_score_count();
+void print_grade_statistics();
+void print_grade_distribution();
+
+#endif /* __REPORT_H__ */
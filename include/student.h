@@ -3,22 +3,27 @@
 
 #include <stdint.h>
 
+#include "common.h"
 #include "linked-list.h"
 
-typedef struct Grade Grade_t;
 typedef struct Dept Dept_t;
 
+/*
+ * Only the fields scans need are kept in the record; the name lives in a
+ * side table indexed by `slot`, and the department is referred to by ID.
+ */
 typedef struct Student
 {
     ListNode_t node;
     uint32_t id;
-    char *name;
+    uint32_t slot;      /* row of the name, see student_name() */
+    uint32_t grade_row; /* row in Grades, GRADE_NONE if not graded */
+    uint32_t dept_id;   /* DEPT_NONE if the student has no department */
     char gender;
-    Grade_t *grade;
-    Dept_t *dept;
 } Student_t;
 
 extern Student_t *Student_Head;
+extern uint32_t Student_Generation;
 
 int32_t cmp_student(ListNode_t *node1, ListNode_t *node2);
 
@@ -27,8 +32,15 @@ void student_from_user();
 void delete_student_from_user();
 void update_student_from_user();
 void print_student();
+void print_student_range();
 Student_t *search_student(uint32_t id);
-void save_students(const char *filename);
+char *student_name(const Student_t *student);
+Student_t *student_put(uint32_t id, const char *name, char gender, Dept_t *dept);
+void student_remove(uint32_t id);
+void orphan_students(Dept_t *dept);
+bool_t save_students(const char *filename);
+void parse_students(const char *filename);
+void link_students();
 void load_students(const char *filename);
 
 #endif /* __STUDENT_H__ */
\ No newline at end of file
@@ -11,5 +11,7 @@ char *get_str(char *header, size_t max_len, int32_t (*filter)(int), char *placeh
 uint32_t get_int(char *prompt, size_t max_length, char *placeholder);
 void popup(char *h1, char *h2, char *h3);
 void press_any_key();
+size_t terminal_width();
+void print_bar(size_t filled, size_t width);
 
 #endif /* __TERMINAL_CONTROL_H__ */
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <stddef.h>
+#include <stdint.h>
+
+#include "column-stats.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define COLUMN_STATS_X86
+#endif
+
+typedef void (*ColumnKernel_t)(const uint8_t *marks, size_t count, uint8_t pass_mark,
+                               ColumnStats_t *stats);
+
+static void column_stats_scalar(const uint8_t *marks, size_t count, uint8_t pass_mark,
+                                ColumnStats_t *stats);
+static ColumnKernel_t select_kernel();
+
+/* picked on first use from what the CPU supports */
+static ColumnKernel_t Column_Kernel = NULL;
+static const char *Column_Kernel_Name = "scalar";
+
+/* adds `count` marks to `stats`, which the SIMD kernels also use for their tails */
+static void column_stats_scalar(const uint8_t *marks, size_t count, uint8_t pass_mark,
+                                ColumnStats_t *stats)
+{
+    uint32_t mark = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        mark = marks[i];
+        stats->sum += mark;
+        stats->sum_squares += mark * mark;
+        stats->passed += (mark >= pass_mark);
+        stats->min = (mark < stats->min) ? mark : stats->min;
+        stats->max = (mark > stats->max) ? mark : stats->max;
+    }
+    stats->count += count;
+}
+
+#ifdef COLUMN_STATS_X86
+/*
+ * 16 marks per step. Sums and pass counts go through psadbw into 64-bit
+ * lanes; squares through pmaddwd into 32-bit lanes, which are widened
+ * every SQUARE_FLUSH steps before they can overflow (each step adds at
+ * most 4 * 255^2 to a lane).
+ */
+    #define SQUARE_FLUSH 4096
+
+__attribute__((target("sse2"))) static void column_stats_sse2(const uint8_t *marks, size_t count,
+                                                              uint8_t pass_mark,
+                                                              ColumnStats_t *stats)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi8(1);
+    const __m128i pass = _mm_set1_epi8((char)pass_mark);
+    __m128i low = _mm_set1_epi8((char)stats->min);
+    __m128i high = _mm_set1_epi8((char)stats->max);
+    __m128i sum = zero, squares = zero, squares32 = zero, passed = zero;
+    __m128i v, wide, passing;
+    size_t blocks = count / 16;
+    uint64_t lanes[2];
+    uint8_t bytes[16];
+
+    for (size_t i = 0; i < blocks; i++)
+    {
+        v = _mm_loadu_si128((const __m128i *)(marks + 16 * i));
+        low = _mm_min_epu8(low, v);
+        high = _mm_max_epu8(high, v);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(v, zero));
+        passing = _mm_cmpeq_epi8(_mm_max_epu8(v, pass), v);
+        passed = _mm_add_epi64(passed, _mm_sad_epu8(_mm_and_si128(passing, ones), zero));
+        wide = _mm_unpacklo_epi8(v, zero);
+        squares32 = _mm_add_epi32(squares32, _mm_madd_epi16(wide, wide));
+        wide = _mm_unpackhi_epi8(v, zero);
+        squares32 = _mm_add_epi32(squares32, _mm_madd_epi16(wide, wide));
+        if ((i + 1) % SQUARE_FLUSH == 0 || i + 1 == blocks)
+        {
+            squares = _mm_add_epi64(squares, _mm_unpacklo_epi32(squares32, zero));
+            squares = _mm_add_epi64(squares, _mm_unpackhi_epi32(squares32, zero));
+            squares32 = zero;
+        }
+    }
+
+    _mm_storeu_si128((__m128i *)lanes, sum);
+    stats->sum += lanes[0] + lanes[1];
+    _mm_storeu_si128((__m128i *)lanes, squares);
+    stats->sum_squares += lanes[0] + lanes[1];
+    _mm_storeu_si128((__m128i *)lanes, passed);
+    stats->passed += lanes[0] + lanes[1];
+    _mm_storeu_si128((__m128i *)bytes, low);
+    for (int i = 0; i < 16; i++)
+    {
+        stats->min = (bytes[i] < stats->min) ? bytes[i] : stats->min;
+    }
+    _mm_storeu_si128((__m128i *)bytes, high);
+    for (int i = 0; i < 16; i++)
+    {
+        stats->max = (bytes[i] > stats->max) ? bytes[i] : stats->max;
+    }
+    stats->count += 16 * blocks;
+
+    column_stats_scalar(marks + 16 * blocks, count % 16, pass_mark, stats);
+}
+
+/* the SSE2 kernel on 32 marks per step */
+__attribute__((target("avx2"))) static void column_stats_avx2(const uint8_t *marks, size_t count,
+                                                              uint8_t pass_mark,
+                                                              ColumnStats_t *stats)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi8(1);
+    const __m256i pass = _mm256_set1_epi8((char)pass_mark);
+    __m256i low = _mm256_set1_epi8((char)stats->min);
+    __m256i high = _mm256_set1_epi8((char)stats->max);
+    __m256i sum = zero, squares = zero, squares32 = zero, passed = zero;
+    __m256i v, wide, passing;
+    size_t blocks = count / 32;
+    uint64_t lanes[4];
+    uint8_t bytes[32];
+
+    for (size_t i = 0; i < blocks; i++)
+    {
+        v = _mm256_loadu_si256((const __m256i *)(marks + 32 * i));
+        low = _mm256_min_epu8(low, v);
+        high = _mm256_max_epu8(high, v);
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(v, zero));
+        passing = _mm256_cmpeq_epi8(_mm256_max_epu8(v, pass), v);
+        passed = _mm256_add_epi64(passed, _mm256_sad_epu8(_mm256_and_si256(passing, ones), zero));
+        wide = _mm256_unpacklo_epi8(v, zero);
+        squares32 = _mm256_add_epi32(squares32, _mm256_madd_epi16(wide, wide));
+        wide = _mm256_unpackhi_epi8(v, zero);
+        squares32 = _mm256_add_epi32(squares32, _mm256_madd_epi16(wide, wide));
+        if ((i + 1) % SQUARE_FLUSH == 0 || i + 1 == blocks)
+        {
+            squares = _mm256_add_epi64(squares, _mm256_unpacklo_epi32(squares32, zero));
+            squares = _mm256_add_epi64(squares, _mm256_unpackhi_epi32(squares32, zero));
+            squares32 = zero;
+        }
+    }
+
+    _mm256_storeu_si256((__m256i *)lanes, sum);
+    stats->sum += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_si256((__m256i *)lanes, squares);
+    stats->sum_squares += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_si256((__m256i *)lanes, passed);
+    stats->passed += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_si256((__m256i *)bytes, low);
+    for (int i = 0; i < 32; i++)
+    {
+        stats->min = (bytes[i] < stats->min) ? bytes[i] : stats->min;
+    }
+    _mm256_storeu_si256((__m256i *)bytes, high);
+    for (int i = 0; i < 32; i++)
+    {
+        stats->max = (bytes[i] > stats->max) ? bytes[i] : stats->max;
+    }
+    stats->count += 32 * blocks;
+
+    column_stats_scalar(marks + 32 * blocks, count % 32, pass_mark, stats);
+}
+#endif /* COLUMN_STATS_X86 */
+
+static ColumnKernel_t select_kernel()
+{
+#ifdef COLUMN_STATS_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        Column_Kernel_Name = "AVX2";
+        return &column_stats_avx2;
+    }
+    if (__builtin_cpu_supports("sse2"))
+    {
+        Column_Kernel_Name = "SSE2";
+        return &column_stats_sse2;
+    }
+#endif
+    Column_Kernel_Name = "scalar";
+    return &column_stats_scalar;
+}
+
+/****************************************************************************
+ * Name: column_stats
+ * Input:
+ *   const uint8_t *marks  Contiguous column of marks.
+ *   size_t count          Number of marks.
+ *   uint8_t pass_mark     Lowest passing mark.
+ *   ColumnStats_t *stats  Receives the summary.
+ * Return:
+ *   None
+ * Description:
+ *   Count, sum, sum of squares, pass count, min and max of the column in
+ *   one pass, using the widest SIMD kernel the CPU supports. The kernel is
+ *   chosen on the first call, which must happen on one thread.
+ ****************************************************************************/
+void column_stats(const uint8_t *marks, size_t count, uint8_t pass_mark, ColumnStats_t *stats)
+{
+    ColumnStats_t empty = {0, 0, 0, 0, UINT8_MAX, 0};
+
+    if (Column_Kernel == NULL)
+    {
+        Column_Kernel = select_kernel();
+    }
+
+    *stats = empty;
+    Column_Kernel(marks, count, pass_mark, stats);
+}
+
+/* name of the kernel column_stats() runs, for display */
+const char *column_stats_kernel()
+{
+    if (Column_Kernel == NULL)
+    {
+        Column_Kernel = select_kernel();
+    }
+    return Column_Kernel_Name;
+}
@@ -1,4 +1,5 @@
 #include <ctype.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,12 +8,35 @@
 #include "common.h"
 #include "dept.h"
 #include "grade.h"
+#include "journal.h"
 #include "menu.h"
 #include "student.h"
 #include "terminal-control.h"
 
+#define DEPT_FILE "data/departments.dat"
+#define STUDENT_FILE "data/students.dat"
+#define GRADE_FILE "data/grades.dat"
+#define JOURNAL_FILE "data/journal.dat"
+
 char **Menu_Options = NULL;
 
+/* generation of each table when its snapshot file was last loaded or written */
+static uint32_t Saved_Dept_Generation = 0;
+static uint32_t Saved_Student_Generation = 0;
+static uint32_t Saved_Grade_Generation = 0;
+
+static bool_t file_exists(const char *filename);
+static bool_t snapshots_exist();
+static bool_t save_snapshots();
+static void *run_parser(void *arg);
+static void parse_tables();
+
+typedef struct TableParser
+{
+    void (*parse)(const char *filename);
+    const char *filename;
+} TableParser_t;
+
 /****************************************************************************
  * Name: string_alloc
  * Input:
@@ -45,13 +69,164 @@ char *string_alloc(const char *literal, size_t max_size)
     return str;
 }
 
+/****************************************************************************
+ * Name: string_copy
+ * Input:
+ *   char *dest        Buffer of at least `max_size` bytes.
+ *   const char *src   String to copy, need not be null-terminated if it is
+ *                     at least `max_size - 1` characters long.
+ *   size_t max_size   Size of `dest`.
+ * Return:
+ *   None
+ * Description:
+ *   Copies at most `max_size - 1` characters of `src` into `dest` and
+ *   terminates it. Used for the fixed-size names stored inline in records.
+ ****************************************************************************/
+void string_copy(char *dest, const char *src, size_t max_size)
+{
+    size_t str_length = strnlen(src, max_size - 1);
+    memcpy(dest, src, str_length);
+    dest[str_length] = '\0';
+}
+
+static bool_t file_exists(const char *filename)
+{
+    struct stat st = {0};
+    return stat(filename, &st) == 0;
+}
+
+static bool_t snapshots_exist()
+{
+    return file_exists(DEPT_FILE) && file_exists(STUDENT_FILE) && file_exists(GRADE_FILE);
+}
+
+/****************************************************************************
+ * Name: save_snapshots
+ * Input: None
+ * Return:
+ *   bool_t  false if writing any of the snapshot files failed.
+ * Description:
+ *   Rewrites the snapshot of every table whose generation counter moved
+ *   since its file was last loaded or written. Untouched tables are skipped.
+ ****************************************************************************/
+static bool_t save_snapshots()
+{
+    if (Dept_Generation != Saved_Dept_Generation || file_exists(DEPT_FILE) == false)
+    {
+        if (save_depts(DEPT_FILE) == false)
+        {
+            return false;
+        }
+        Saved_Dept_Generation = Dept_Generation;
+    }
+
+    if (Student_Generation != Saved_Student_Generation || file_exists(STUDENT_FILE) == false)
+    {
+        if (save_students(STUDENT_FILE) == false)
+        {
+            return false;
+        }
+        Saved_Student_Generation = Student_Generation;
+    }
+
+    if (Grade_Generation != Saved_Grade_Generation || file_exists(GRADE_FILE) == false)
+    {
+        if (save_grades(GRADE_FILE) == false)
+        {
+            return false;
+        }
+        Saved_Grade_Generation = Grade_Generation;
+    }
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: save_database
+ * Input: None
+ * Return: None
+ * Description:
+ *   Appends the changes made since the last save to the journal. When the
+ *   journal has grown too large, or a snapshot file is missing, the
+ *   snapshots of the changed tables are rewritten instead and the journal
+ *   is dropped.
+ ****************************************************************************/
 void save_database()
 {
-    save_depts("data/departments.dat");
-    save_students("data/students.dat");
-    save_grades("data/grades.dat");
+    if (journal_should_compact() == false && snapshots_exist() == true &&
+        journal_flush(JOURNAL_FILE) == true)
+    {
+        return;
+    }
+
+    if (save_snapshots() == true)
+    {
+        journal_reset(JOURNAL_FILE);
+    }
+}
+
+static void *run_parser(void *arg)
+{
+    TableParser_t *parser = (TableParser_t *)arg;
+    parser->parse(parser->filename);
+    return NULL;
 }
 
+/****************************************************************************
+ * Name: parse_tables
+ * Input: None
+ * Return: None
+ * Description:
+ *   Parses the three snapshot files. With USE_PARALLEL_LOAD each file gets
+ *   its own thread; the parsers share no state, and a parser whose thread
+ *   could not be started simply runs on the calling thread.
+ ****************************************************************************/
+static void parse_tables()
+{
+    TableParser_t parsers[] = {
+        {&parse_depts, DEPT_FILE},
+        {&parse_students, STUDENT_FILE},
+        {&parse_grades, GRADE_FILE},
+    };
+    size_t parser_count = sizeof(parsers) / sizeof(parsers[0]);
+
+#ifdef USE_PARALLEL_LOAD
+    pthread_t threads[sizeof(parsers) / sizeof(parsers[0])];
+    bool_t started[sizeof(parsers) / sizeof(parsers[0])] = {false};
+
+    for (size_t i = 0; i < parser_count; i++)
+    {
+        started[i] = (pthread_create(&threads[i], NULL, &run_parser, &parsers[i]) == 0);
+    }
+    for (size_t i = 0; i < parser_count; i++)
+    {
+        if (started[i] == true)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        else
+        {
+            run_parser(&parsers[i]);
+        }
+    }
+#else
+    for (size_t i = 0; i < parser_count; i++)
+    {
+        run_parser(&parsers[i]);
+    }
+#endif
+
+    return;
+}
+
+/****************************************************************************
+ * Name: load_database
+ * Input: None
+ * Return: None
+ * Description:
+ *   Parses the snapshot files, then links departments, students and grades
+ *   on the main thread in that order, and finally replays the journal.
+ ****************************************************************************/
 void load_database()
 {
     /* create directory 'data' */
@@ -65,17 +240,26 @@ void load_database()
             return;
         }
     }
-    load_depts("data/departments.dat");
-    load_students("data/students.dat");
-    load_grades("data/grades.dat");
+    parse_tables();
+    link_depts();
+    link_students();
+    link_grades();
+
+    /* the snapshots match memory now, changes replayed from the journal do not */
+    Saved_Dept_Generation = Dept_Generation;
+    Saved_Student_Generation = Student_Generation;
+    Saved_Grade_Generation = Grade_Generation;
+    journal_replay(JOURNAL_FILE);
 }
 
 void cleanup_and_exit()
 {
     reset_terminal();
     release_menu_resources();
-    cleanup_dept();
     cleanup_student();
+    cleanup_dept();
+    cleanup_grade();
+    cleanup_journal();
     if (Menu_Options != NULL)
     {
         free(Menu_Options);
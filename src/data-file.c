@@ -0,0 +1,645 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "data-file.h"
+
+#define DATA_WRITER_BUFFER_SIZE (1 << 20)
+#define TEMP_SUFFIX ".tmp"
+#define FNV_OFFSET_BASIS 0x811C9DC5U
+#define FNV_PRIME 0x01000193U
+
+static uint32_t checksum_update(uint32_t checksum, const uint8_t *data, size_t size);
+static bool_t data_reader_fread(DataReader_t *reader, int fd);
+static bool_t write_all(int fd, const uint8_t *data, size_t size);
+static void data_writer_flush(DataWriter_t *writer);
+static void data_writer_close(DataWriter_t *writer);
+static void sync_parent_dir(const char *filename);
+static uint32_t header_checksum(uint32_t checksum, DataHeader_t header);
+
+/* 32-bit FNV-1a over the payload, seeded with FNV_OFFSET_BASIS */
+static uint32_t checksum_update(uint32_t checksum, const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        checksum ^= data[i];
+        checksum *= FNV_PRIME;
+    }
+    return checksum;
+}
+
+/* continues a payload checksum over the header, whose own checksum counts as 0 */
+static uint32_t header_checksum(uint32_t checksum, DataHeader_t header)
+{
+    header.checksum = 0;
+    return checksum_update(checksum, (const uint8_t *)&header, sizeof(header));
+}
+
+/* fallback for files that can not be mapped, reads the whole file with stdio */
+static bool_t data_reader_fread(DataReader_t *reader, int fd)
+{
+    FILE *file = NULL;
+    uint8_t *buffer = NULL;
+
+    file = fdopen(fd, "rb");
+    if (file == NULL)
+    {
+        return false;
+    }
+
+    buffer = (uint8_t *)malloc(reader->size);
+    if (buffer == NULL || fread(buffer, 1, reader->size, file) != reader->size)
+    {
+        free(buffer);
+        fclose(file);
+        return false;
+    }
+    fclose(file);
+
+    reader->data = buffer;
+    reader->mapped = false;
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: data_reader_open
+ * Input:
+ *   DataReader_t *reader  Reader to initialize.
+ *   const char *filename  Path of the file to read.
+ * Return:
+ *   bool_t                false if the file could not be opened or read.
+ * Description:
+ *   Maps the whole file read-only and hints the kernel that it will be read
+ *   sequentially. If mapping fails the file is read into a heap buffer with
+ *   fread() instead, so callers always parse from memory.
+ ****************************************************************************/
+bool_t data_reader_open(DataReader_t *reader, const char *filename)
+{
+    int fd = -1;
+    struct stat st = {0};
+    void *data = NULL;
+
+    memset(reader, 0, sizeof(DataReader_t));
+
+    fd = open(filename, O_RDONLY);
+    if (fd == -1)
+    {
+        return false;
+    }
+
+    if (fstat(fd, &st) == -1)
+    {
+        close(fd);
+        return false;
+    }
+
+    reader->size = (size_t)st.st_size;
+    if (reader->size == 0)
+    {
+        close(fd);
+        return true;
+    }
+
+    data = mmap(NULL, reader->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        return data_reader_fread(reader, fd);
+    }
+    close(fd);
+
+    madvise(data, reader->size, MADV_SEQUENTIAL);
+    reader->data = (const uint8_t *)data;
+    reader->mapped = true;
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: data_reader_header
+ * Input:
+ *   DataReader_t *reader    Freshly opened reader.
+ *   uint32_t magic          Magic number expected for this table.
+ *   size_t min_record_size  Fewest bytes any record of this table takes in
+ *                           the file.
+ * Return:
+ *   DataHeaderStatus_t      DATA_HEADER_OK if a valid header was consumed,
+ *                           DATA_HEADER_LEGACY if the file has no header, or
+ *                           an error status for a header that can not be
+ *                           used.
+ * Description:
+ *   Checks for the versioned file header and verifies the checksum, which
+ *   covers the payload and, since version 2, the header itself. Callers
+ *   size allocations from the record count, so a count the payload could
+ *   not hold is rejected even when the checksum matches.
+ *   Files written before the header existed start directly with a record and
+ *   are detected by the missing magic number; the reader is left at the
+ *   start of the file for them and `reader->header.record_count` is 0.
+ ****************************************************************************/
+DataHeaderStatus_t data_reader_header(DataReader_t *reader, uint32_t magic,
+                                      size_t min_record_size)
+{
+    DataHeader_t header = {0};
+    uint32_t checksum = 0;
+
+    memset(&reader->header, 0, sizeof(DataHeader_t));
+    if (data_reader_remaining(reader) < sizeof(DataHeader_t))
+    {
+        return DATA_HEADER_LEGACY;
+    }
+
+    memcpy(&header, reader->data + reader->pos, sizeof(DataHeader_t));
+    if (header.magic != magic)
+    {
+        return DATA_HEADER_LEGACY;
+    }
+    if (header.version > DATA_FILE_VERSION || (header.flags & ~DATA_FLAGS_KNOWN) != 0)
+    {
+        return DATA_HEADER_BAD_VERSION;
+    }
+
+    reader->pos += sizeof(DataHeader_t);
+    checksum = checksum_update(FNV_OFFSET_BASIS, reader->data + reader->pos,
+                               data_reader_remaining(reader));
+    if (header.version >= 2)
+    {
+        checksum = header_checksum(checksum, header);
+    }
+    if (checksum != header.checksum)
+    {
+        return DATA_HEADER_BAD_CHECKSUM;
+    }
+    if (min_record_size > 0 &&
+        header.record_count > data_reader_remaining(reader) / min_record_size)
+    {
+        return DATA_HEADER_BAD_COUNT;
+    }
+    reader->header = header;
+
+    return DATA_HEADER_OK;
+}
+
+uint32_t data_checksum(const void *data, size_t size)
+{
+    return checksum_update(FNV_OFFSET_BASIS, (const uint8_t *)data, size);
+}
+
+const char *data_header_error(DataHeaderStatus_t status)
+{
+    switch (status)
+    {
+        case DATA_HEADER_BAD_VERSION:
+            return "Unsupported file format version";
+        case DATA_HEADER_BAD_CHECKSUM:
+            return "Checksum mismatch, file is corrupted";
+        case DATA_HEADER_BAD_COUNT:
+            return "Record count does not fit the file, file is corrupted";
+        default:
+            return NULL;
+    }
+}
+
+/****************************************************************************
+ * Name: data_reader_take
+ * Input:
+ *   DataReader_t *reader  Reader to consume from.
+ *   size_t size           Number of bytes to consume.
+ * Return:
+ *   const uint8_t *       Pointer to the next `size` bytes of the file, or
+ *                         NULL if fewer than `size` bytes remain.
+ * Description:
+ *   Consumes `size` bytes without copying them. The returned pointer stays
+ *   valid until the reader is closed.
+ ****************************************************************************/
+const uint8_t *data_reader_take(DataReader_t *reader, size_t size)
+{
+    const uint8_t *ptr = NULL;
+
+    if (size > reader->size - reader->pos)
+    {
+        return NULL;
+    }
+    ptr = reader->data + reader->pos;
+    reader->pos += size;
+
+    return ptr;
+}
+
+bool_t data_reader_read(DataReader_t *reader, void *dest, size_t size)
+{
+    const uint8_t *ptr = data_reader_take(reader, size);
+    if (ptr == NULL)
+    {
+        return false;
+    }
+    memcpy(dest, ptr, size);
+    return true;
+}
+
+/****************************************************************************
+ * Name: data_reader_read_varint
+ * Input:
+ *   DataReader_t *reader  Reader to consume from.
+ *   uint32_t *value       Receives the decoded value.
+ * Return:
+ *   bool_t                false if the varint is truncated or does not fit
+ *                         in 32 bits.
+ * Description:
+ *   Decodes an unsigned LEB128 varint: 7 bits per byte, least significant
+ *   group first, high bit set on every byte but the last.
+ ****************************************************************************/
+bool_t data_reader_read_varint(DataReader_t *reader, uint32_t *value)
+{
+    uint32_t result = 0;
+    uint8_t byte = 0;
+
+    for (uint32_t shift = 0; shift < 35; shift += 7)
+    {
+        if (reader->pos >= reader->size)
+        {
+            return false;
+        }
+        byte = reader->data[reader->pos++];
+        if (shift == 28 && byte > 0x0F)
+        {
+            return false;
+        }
+        result |= (uint32_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            *value = result;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t data_reader_remaining(const DataReader_t *reader)
+{
+    return reader->size - reader->pos;
+}
+
+void data_reader_close(DataReader_t *reader)
+{
+    if (reader->data != NULL)
+    {
+        if (reader->mapped == true)
+        {
+            munmap((void *)reader->data, reader->size);
+        }
+        else
+        {
+            free((void *)reader->data);
+        }
+    }
+    memset(reader, 0, sizeof(DataReader_t));
+}
+
+static bool_t write_all(int fd, const uint8_t *data, size_t size)
+{
+    ssize_t written = 0;
+
+    while (size > 0)
+    {
+        written = write(fd, data, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return false;
+        }
+        data += written;
+        size -= (size_t)written;
+    }
+
+    return true;
+}
+
+static void data_writer_flush(DataWriter_t *writer)
+{
+    if (writer->failed == false && write_all(writer->fd, writer->buffer, writer->used) == false)
+    {
+        writer->failed = true;
+    }
+    writer->used = 0;
+}
+
+static void data_writer_close(DataWriter_t *writer)
+{
+    if (writer->fd != -1)
+    {
+        close(writer->fd);
+    }
+    free(writer->buffer);
+    free(writer->filename);
+    free(writer->temp_filename);
+    memset(writer, 0, sizeof(DataWriter_t));
+    writer->fd = -1;
+}
+
+/* makes the rename() of a file in the directory durable */
+static void sync_parent_dir(const char *filename)
+{
+    char *dir = NULL;
+    char *slash = NULL;
+    int fd = -1;
+
+    dir = string_alloc(filename, strlen(filename) + 1);
+    if (dir == NULL)
+    {
+        return;
+    }
+    slash = strrchr(dir, '/');
+    if (slash == NULL)
+    {
+        strcpy(dir, ".");
+    }
+    else
+    {
+        *slash = '\0';
+    }
+
+    fd = open(dir, O_RDONLY | O_DIRECTORY);
+    if (fd != -1)
+    {
+        fsync(fd);
+        close(fd);
+    }
+    free(dir);
+}
+
+/****************************************************************************
+ * Name: data_writer_open
+ * Input:
+ *   DataWriter_t *writer  Writer to initialize.
+ *   const char *filename  Path of the file to replace.
+ *   uint32_t magic        Magic number of the table written to the header.
+ *   uint16_t flags        Encoding flags written to the header.
+ * Return:
+ *   bool_t                false if the temporary file could not be created.
+ * Description:
+ *   Creates `filename` with a ".tmp" suffix and a large output buffer, and
+ *   reserves room for the file header. Nothing touches `filename` itself
+ *   until data_writer_commit().
+ ****************************************************************************/
+bool_t data_writer_open(DataWriter_t *writer, const char *filename, uint32_t magic,
+                        uint16_t flags)
+{
+    size_t length = strlen(filename);
+
+    memset(writer, 0, sizeof(DataWriter_t));
+    writer->fd = -1;
+
+    writer->filename = string_alloc(filename, length + 1);
+    writer->temp_filename = (char *)malloc(length + sizeof(TEMP_SUFFIX));
+    writer->buffer = (uint8_t *)malloc(DATA_WRITER_BUFFER_SIZE);
+    if (writer->filename == NULL || writer->temp_filename == NULL || writer->buffer == NULL)
+    {
+        data_writer_close(writer);
+        return false;
+    }
+    memcpy(writer->temp_filename, filename, length);
+    memcpy(writer->temp_filename + length, TEMP_SUFFIX, sizeof(TEMP_SUFFIX));
+
+    writer->fd = open(writer->temp_filename, O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (writer->fd == -1)
+    {
+        data_writer_close(writer);
+        return false;
+    }
+
+    /* the header is filled in by data_writer_commit() once the payload is known */
+    writer->magic = magic;
+    writer->flags = flags;
+    writer->checksum = FNV_OFFSET_BASIS;
+    writer->used = sizeof(DataHeader_t);
+    memset(writer->buffer, 0, sizeof(DataHeader_t));
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: data_writer_put
+ * Input:
+ *   DataWriter_t *writer  Writer to append to.
+ *   const void *data      Bytes to append.
+ *   size_t size           Number of bytes to append.
+ * Return:
+ *   None
+ * Description:
+ *   Appends to the output buffer, which is written out with a single write()
+ *   whenever it fills up. Errors are remembered and reported by
+ *   data_writer_commit(), so callers do not need to check every record.
+ ****************************************************************************/
+void data_writer_put(DataWriter_t *writer, const void *data, size_t size)
+{
+    writer->checksum = checksum_update(writer->checksum, (const uint8_t *)data, size);
+    if (writer->used + size > DATA_WRITER_BUFFER_SIZE)
+    {
+        data_writer_flush(writer);
+        if (size > DATA_WRITER_BUFFER_SIZE)
+        {
+            if (writer->failed == false && write_all(writer->fd, data, size) == false)
+            {
+                writer->failed = true;
+            }
+            return;
+        }
+    }
+    memcpy(writer->buffer + writer->used, data, size);
+    writer->used += size;
+}
+
+void data_writer_put_varint(DataWriter_t *writer, uint32_t value)
+{
+    uint8_t bytes[5];
+    size_t length = 0;
+
+    while (value >= 0x80)
+    {
+        bytes[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    bytes[length++] = (uint8_t)value;
+
+    data_writer_put(writer, bytes, length);
+}
+
+/****************************************************************************
+ * Name: data_writer_commit
+ * Input:
+ *   DataWriter_t *writer   Writer to finish.
+ *   uint32_t record_count  Number of records written, stored in the header.
+ * Return:
+ *   bool_t                 false if any write failed; the original file is
+ *                          then left untouched.
+ * Description:
+ *   Flushes the buffer, writes the header with the record count and the
+ *   checksum of payload and header, fsyncs the temporary file and renames
+ *   it over the original, so a crash leaves either the old or the new file,
+ *   never a partial one. The writer is closed in every case.
+ ****************************************************************************/
+bool_t data_writer_commit(DataWriter_t *writer, uint32_t record_count)
+{
+    DataHeader_t header = {0};
+
+    header.magic = writer->magic;
+    header.version = DATA_FILE_VERSION;
+    header.flags = writer->flags;
+    header.record_count = record_count;
+    header.checksum = header_checksum(writer->checksum, header);
+
+    data_writer_flush(writer);
+    if (writer->failed == true ||
+        pwrite(writer->fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        fsync(writer->fd) == -1)
+    {
+        data_writer_abort(writer);
+        return false;
+    }
+
+    close(writer->fd);
+    writer->fd = -1;
+    if (rename(writer->temp_filename, writer->filename) == -1)
+    {
+        data_writer_abort(writer);
+        return false;
+    }
+    sync_parent_dir(writer->filename);
+    data_writer_close(writer);
+
+    return true;
+}
+
+void data_writer_abort(DataWriter_t *writer)
+{
+    if (writer->temp_filename != NULL)
+    {
+        unlink(writer->temp_filename);
+    }
+    data_writer_close(writer);
+}
+
+/****************************************************************************
+ * Name: parsed_table_open
+ * Input:
+ *   ParsedTable_t *table    Table to initialise.
+ *   const char *filename    Path of the snapshot file.
+ *   uint32_t magic          Magic number the file must carry.
+ *   size_t record_size      Size of one parsed record in bytes.
+ *   size_t min_stored_size  Fewest bytes one record takes in the file, in
+ *                           any format.
+ * Return:
+ *   bool_t                  false if the file can not be read;
+ *                           `table->error` tells why.
+ * Description:
+ *   Opens and validates the snapshot file and sizes the record arrays from
+ *   the record count in its header, which data_reader_header() has checked
+ *   against the size of the payload.
+ ****************************************************************************/
+bool_t parsed_table_open(ParsedTable_t *table, const char *filename, uint32_t magic,
+                         size_t record_size, size_t min_stored_size)
+{
+    DataHeaderStatus_t status = DATA_HEADER_OK;
+
+    memset(table, 0, sizeof(ParsedTable_t));
+    table->filename = filename;
+    table->record_size = record_size;
+
+    if (data_reader_open(&table->reader, filename) == false)
+    {
+        table->error = "Error opening file for reading";
+        return false;
+    }
+
+    status = data_reader_header(&table->reader, magic, min_stored_size);
+    if (status != DATA_HEADER_OK && status != DATA_HEADER_LEGACY)
+    {
+        data_reader_close(&table->reader);
+        table->error = data_header_error(status);
+        return false;
+    }
+
+    if (parsed_table_reserve(table, table->reader.header.record_count) == false)
+    {
+        data_reader_close(&table->reader);
+        return false;
+    }
+
+    return true;
+}
+
+bool_t parsed_table_reserve(ParsedTable_t *table, size_t capacity)
+{
+    uint8_t *records = NULL;
+    uint32_t *keys = NULL;
+
+    if (capacity <= table->capacity)
+    {
+        return true;
+    }
+
+    records = (uint8_t *)realloc(table->records, capacity * table->record_size);
+    if (records == NULL)
+    {
+        table->error = "Memory allocation failed";
+        return false;
+    }
+    table->records = records;
+
+    keys = (uint32_t *)realloc(table->keys, capacity * sizeof(uint32_t));
+    if (keys == NULL)
+    {
+        table->error = "Memory allocation failed";
+        return false;
+    }
+    table->keys = keys;
+    table->capacity = capacity;
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: parsed_table_add
+ * Input:
+ *   ParsedTable_t *table  Table to append to.
+ *   uint32_t key          Lookup key of the new record.
+ * Return:
+ *   void *                The uninitialised new record, NULL if the arrays
+ *                         could not grow.
+ ****************************************************************************/
+void *parsed_table_add(ParsedTable_t *table, uint32_t key)
+{
+    if (table->count == table->capacity &&
+        parsed_table_reserve(table, (table->capacity == 0) ? 1024 : table->capacity * 2) == false)
+    {
+        return NULL;
+    }
+
+    table->keys[table->count] = key;
+    return table->records + table->record_size * table->count++;
+}
+
+void *parsed_table_record(const ParsedTable_t *table, size_t index)
+{
+    return table->records + table->record_size * index;
+}
+
+void parsed_table_free(ParsedTable_t *table)
+{
+    data_reader_close(&table->reader);
+    free(table->records);
+    free(table->keys);
+    table->records = NULL;
+    table->keys = NULL;
+    table->count = 0;
+    table->capacity = 0;
+}
@@ -1,24 +1,50 @@
 #include <ctype.h>
 #include <inttypes.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "common.h"
+#include "data-file.h"
 #include "dept.h"
+#include "grade.h"
+#include "hash-index.h"
+#include "journal.h"
 #include "linked-list.h"
+#include "pool.h"
 #include "student.h"
 #include "terminal-control.h"
 
 Dept_t *Dept_Head = NULL;
+uint32_t Dept_Generation = 0;
 static uint32_t Dept_ID = 1;
-
-static Dept_t *create_dept(const char *name);
+/* used by parse_depts() on a loader thread, and only by the main thread after it */
+static Pool_t Dept_Pool = POOL_INITIALIZER(Dept_t, 64);
+static ParsedTable_t Parsed_Depts = {0};
+static SkipIndex_t Dept_Lanes = SKIP_INDEX_INITIALIZER;
+
+/* compact records: one-byte ID delta and the length of an empty name */
+#define DEPT_MIN_RECORD_SIZE 2
+
+/*
+ * Department lookup by ID. IDs are handed out sequentially, so those below
+ * DEPT_DENSE_LIMIT map straight into Dept_Table; larger ones, which only
+ * come from hand-edited or foreign data files, go to a hash index.
+ */
+#define DEPT_DENSE_LIMIT (1U << 20)
+static Dept_t **Dept_Table = NULL;
+static uint32_t Dept_Table_Size = 0;
+static HashIndex_t Dept_Sparse_Index = {0};
+
+static Dept_t *create_dept(uint32_t id, const char *name);
 static int32_t cmp_dept(ListNode_t *node1, ListNode_t *node2);
 static void free_dept(ListNode_t *node);
-static void count_male_female(Student_t *head, uint32_t *male, uint32_t *female);
+static bool_t dept_index_insert(Dept_t *dept);
+static void dept_index_remove(uint32_t id);
+static void print_subject_stats(const DeptStats_t *stats, int subject);
 
-static Dept_t *create_dept(const char *name)
+static Dept_t *create_dept(uint32_t id, const char *name)
 {
     if (name == NULL)
     {
@@ -28,7 +54,7 @@ static Dept_t *create_dept(const char *name)
         return NULL;
     }
 
-    Dept_t *new_dept = (Dept_t *)calloc(1, sizeof(Dept_t));
+    Dept_t *new_dept = (Dept_t *)pool_alloc(&Dept_Pool);
     if (new_dept == NULL)
     {
         fprintf(stderr, "Memory allocation failed\nNot enough memory to create new department.");
@@ -37,17 +63,10 @@ static Dept_t *create_dept(const char *name)
         return NULL;
     }
 
-    new_dept->id = Dept_ID++;
+    new_dept->id = id;
     new_dept->students = NULL;
-    new_dept->name = string_alloc(name, DEPT_NAME_SIZE);
-    if (new_dept->name == NULL)
-    {
-        fprintf(stderr, "Memory allocation failed\nNot enough memory to allocate department name.");
-        free(new_dept);
-        press_any_key();
-
-        return NULL;
-    }
+    skip_index_init(&new_dept->student_lanes);
+    string_copy(new_dept->name, name, DEPT_NAME_SIZE);
 
     return new_dept;
 }
@@ -70,59 +89,218 @@ int32_t match_dept(ListNode_t *node, uint32_t id)
     return compare_uint32(((Dept_t *)node)->id, id);
 }
 
-static void free_dept(ListNode_t *node)
+static bool_t dept_index_insert(Dept_t *dept)
 {
-    Dept_t *dept = (Dept_t *)node;
-    Student_t *student = NULL;
-    if (dept->name != NULL)
+    uint32_t size = Dept_Table_Size;
+    Dept_t **table = NULL;
+
+    if (dept->id >= DEPT_DENSE_LIMIT)
     {
-        free(dept->name);
+        return hash_index_insert(&Dept_Sparse_Index, dept->id, dept);
     }
-    if (dept->students != NULL)
+
+    if (dept->id >= size)
     {
-        student = dept->students;
-        while (student != NULL)
+        size = (size == 0) ? 64 : size;
+        while (size <= dept->id)
+        {
+            size *= 2;
+        }
+        table = (Dept_t **)realloc(Dept_Table, size * sizeof(Dept_t *));
+        if (table == NULL)
         {
-            student->dept = NULL;
-            student = (Student_t *)student->node.next;
+            return false;
         }
-        merge_sorted((ListNode_t **)&Student_Head, (ListNode_t *)dept->students, &cmp_student);
+        memset(table + Dept_Table_Size, 0, (size - Dept_Table_Size) * sizeof(Dept_t *));
+        Dept_Table = table;
+        Dept_Table_Size = size;
+    }
+    Dept_Table[dept->id] = dept;
+
+    return true;
+}
+
+static void dept_index_remove(uint32_t id)
+{
+    if (id >= DEPT_DENSE_LIMIT)
+    {
+        hash_index_remove(&Dept_Sparse_Index, id);
+    }
+    else if (id < Dept_Table_Size)
+    {
+        Dept_Table[id] = NULL;
     }
-    free(dept);
 }
 
-static void count_male_female(Student_t *head, uint32_t *male, uint32_t *female)
+/* O(1) through the department index, NULL for DEPT_NONE or unknown IDs */
+Dept_t *search_dept(uint32_t id)
 {
-    *male = 0;
-    *female = 0;
+    if (id < Dept_Table_Size)
+    {
+        return Dept_Table[id];
+    }
+    if (id >= DEPT_DENSE_LIMIT)
+    {
+        return (Dept_t *)hash_index_find(&Dept_Sparse_Index, id);
+    }
+    return NULL;
+}
 
-    while (head != NULL)
+/****************************************************************************
+ * Name: dept_put
+ * Input:
+ *   uint32_t id       ID of the department.
+ *   const char *name  Name of the department.
+ * Return:
+ *   Dept_t *          The created or renamed department, NULL on failure.
+ * Description:
+ *   Creates the department with the given ID, or renames it if it already
+ *   exists. This is the non-interactive part of adding and editing a
+ *   department, shared with journal replay.
+ ****************************************************************************/
+Dept_t *dept_put(uint32_t id, const char *name)
+{
+    Dept_t *dept = NULL;
+
+    dept = search_dept(id);
+    if (dept == NULL)
     {
-        if (head->gender == 'm')
+        dept = create_dept(id, name);
+        if (dept == NULL)
+        {
+            return NULL;
+        }
+        if (dept_index_insert(dept) == false)
         {
-            (*male)++;
+            fprintf(stderr, "Memory allocation failed\nNot enough memory to index new department.");
+            pool_free(&Dept_Pool, dept);
+            press_any_key();
+            return NULL;
         }
-        else if (head->gender == 'f')
+        skip_insert(&Dept_Lanes, (ListNode_t **)&Dept_Head, (ListNode_t *)dept, &cmp_dept);
+        if (id >= Dept_ID)
         {
-            (*female)++;
+            Dept_ID = id + 1;
         }
-        head = (Student_t *)head->node.next;
+        Dept_Generation++;
+        return dept;
+    }
+
+    string_copy(dept->name, name, DEPT_NAME_SIZE);
+    Dept_Generation++;
+
+    return dept;
+}
+
+void dept_remove(uint32_t id)
+{
+    Dept_t *dept = search_dept(id);
+    if (dept != NULL)
+    {
+        dept_index_remove(id);
+        skip_delete(&Dept_Lanes, (ListNode_t **)&Dept_Head, (ListNode_t *)dept, &cmp_dept,
+                    &free_dept);
+        Dept_Generation++;
+    }
+}
+
+static void free_dept(ListNode_t *node)
+{
+    Dept_t *dept = (Dept_t *)node;
+
+    orphan_students(dept);
+    pool_free(&Dept_Pool, dept);
+}
+
+/****************************************************************************
+ * Name: dept_stats_apply
+ * Input:
+ *   Dept_t *dept             Department of the student, NULL for none.
+ *   const Student_t *student Student joining or leaving the totals.
+ *   int32_t delta            1 to add the student, -1 to take it out.
+ * Return:
+ *   None
+ * Description:
+ *   Adds or removes the student's gender and, if graded, its marks in the
+ *   department totals. Anything that changes a student's department,
+ *   gender or grades takes it out with the old values and adds it back
+ *   with the new ones.
+ ****************************************************************************/
+void dept_stats_apply(Dept_t *dept, const Student_t *student, int32_t delta)
+{
+    DeptStats_t *stats = NULL;
+    uint32_t row = 0;
+    uint64_t marks[SUBJECT_COUNT] = {0};
+
+    if (dept == NULL || student == NULL)
+    {
+        return;
+    }
+
+    stats = &dept->stats;
+    stats->headcount += delta;
+    if (student->gender == 'm')
+    {
+        stats->male += delta;
+    }
+    else if (student->gender == 'f')
+    {
+        stats->female += delta;
+    }
+
+    row = student->grade_row;
+    if (row == GRADE_NONE)
+    {
+        return;
+    }
+
+    marks[0] = Grades.english[row];
+    marks[1] = Grades.math[row];
+    marks[2] = Grades.history[row];
+    stats->graded += delta;
+    for (int i = 0; i < SUBJECT_COUNT; i++)
+    {
+        /* unsigned wrap-around makes subtracting through delta exact */
+        stats->sum[i] += delta * marks[i];
+        stats->sum_squares[i] += delta * marks[i] * marks[i];
     }
 
     return;
 }
 
-void cleanup_dept()
+/* "mean/sd" of one subject, or a dash when nobody in the department is graded */
+static void print_subject_stats(const DeptStats_t *stats, int subject)
 {
-    while (Dept_Head != NULL)
+    double mean = 0.0;
+    double variance = 0.0;
+
+    if (stats->graded == 0)
     {
-        delete_node((ListNode_t **)&Dept_Head, (ListNode_t *)Dept_Head, &free_dept);
+        printf(PIPE2 "      -     ");
+        return;
     }
+
+    mean = (double)stats->sum[subject] / stats->graded;
+    variance = (double)stats->sum_squares[subject] / stats->graded - mean * mean;
+    printf(PIPE2 " %5.1f/%-4.1f ", mean, (variance > 0.0) ? sqrt(variance) : 0.0);
+}
+
+/* releases every department at once, cleanup_student() must have run first */
+void cleanup_dept()
+{
+    Dept_Head = NULL;
+    skip_index_free(&Dept_Lanes);
+    pool_release(&Dept_Pool);
+    free(Dept_Table);
+    Dept_Table = NULL;
+    Dept_Table_Size = 0;
+    hash_index_free(&Dept_Sparse_Index);
 }
 
 void dept_from_user()
 {
     char *str = NULL;
+    Dept_t *dept = NULL;
 
     str = get_str("Enter Department Name", DEPT_NAME_SIZE, &isprint, NULL);
     if (str == NULL || str[0] == '\0')
@@ -132,7 +310,11 @@ void dept_from_user()
         return;
     }
 
-    insert_sorted((ListNode_t **)&Dept_Head, (ListNode_t *)create_dept(str), &cmp_dept);
+    dept = dept_put(Dept_ID, str);
+    if (dept != NULL)
+    {
+        journal_dept_put(dept);
+    }
     free(str);
 
     return;
@@ -150,14 +332,15 @@ void delete_dept_from_user()
         return;
     }
 
-    dept = (Dept_t *)search_sorted(id, &match_dept, (ListNode_t *)Dept_Head);
+    dept = search_dept(id);
     if (dept == NULL)
     {
         popup("Error", "No Department found with this ID.", "OK");
         return;
     }
 
-    delete_node((ListNode_t **)&Dept_Head, (ListNode_t *)dept, &free_dept);
+    dept_remove(id);
+    journal_dept_delete(id);
 
     return;
 }
@@ -175,7 +358,7 @@ void update_dept_from_user()
         return;
     }
 
-    dept = (Dept_t *)search_sorted(id, &match_dept, (ListNode_t *)Dept_Head);
+    dept = search_dept(id);
     if (dept == NULL)
     {
         popup("Error", "No Department found with this ID.", "OK");
@@ -190,8 +373,12 @@ void update_dept_from_user()
         return;
     }
 
-    free(dept->name);
-    dept->name = str;
+    dept = dept_put(id, str);
+    if (dept != NULL)
+    {
+        journal_dept_put(dept);
+    }
+    free(str);
 
     return;
 }
@@ -199,144 +386,256 @@ void update_dept_from_user()
 void print_dept()
 {
     Dept_t *dept = Dept_Head;
-    uint32_t male = 0, female = 0;
+    DeptStats_t *stats = NULL;
 
     system("clear");
 #ifdef USE_UNICODE
-    printf("┌─────────┬──────────────────────┬──────┬────────┐\n");
-    printf("│ Dept ID │       Dept Name      │ Male │ Female │\n");
-    printf("├─────────┼──────────────────────┼──────┼────────┤\n");
+    printf("┌─────────┬──────────────────────┬───────┬───────┬────────┬────────┬────────────┬─────"
+           "───────┬────────────┐\n");
+    printf("│ Dept ID │       Dept Name      │ Total │  Male │ Female │ Graded │ English    │ Math"
+           "       │ History    │\n");
+    printf("│         │                      │       │       │        │        │  mean/sd   │  mea"
+           "n/sd   │  mean/sd   │\n");
+    printf("├─────────┼──────────────────────┼───────┼───────┼────────┼────────┼────────────┼─────"
+           "───────┼────────────┤\n");
 #else
-    printf("+---------+----------------------+------+--------+\n");
-    printf("| Dept ID |       Dept Name      | Male | Female |\n");
-    printf("+---------+----------------------+------+--------+\n");
+    printf("+---------+----------------------+-------+-------+--------+--------+------------+-----"
+           "-------+------------+\n");
+    printf("| Dept ID |       Dept Name      | Total |  Male | Female | Graded | English    | Math"
+           "       | History    |\n");
+    printf("|         |                      |       |       |        |        |  mean/sd   |  mea"
+           "n/sd   |  mean/sd   |\n");
+    printf("+---------+----------------------+-------+-------+--------+--------+------------+-----"
+           "-------+------------+\n");
 #endif
     while (dept != NULL)
     {
-        count_male_female(dept->students, &male, &female);
-        printf(PIPE2 " %7" PRIu32 " " PIPE2 " %*.*s " PIPE2 " %4" PRIu32 " " PIPE2 "   %4" PRIu32
-                     " " PIPE2 "\n",
-               dept->id, DEPT_NAME_SIZE, DEPT_NAME_SIZE, dept->name, male, female);
+        stats = &dept->stats;
+        printf(PIPE2 " %7" PRIu32 " " PIPE2 " %*.*s " PIPE2 " %5" PRIu32 " " PIPE2 " %5" PRIu32
+                     " " PIPE2 "  %5" PRIu32 " " PIPE2 "  %5" PRIu32 " ",
+               dept->id, DEPT_NAME_SIZE, DEPT_NAME_SIZE, dept->name, stats->headcount,
+               stats->male, stats->female, stats->graded);
+        for (int i = 0; i < SUBJECT_COUNT; i++)
+        {
+            print_subject_stats(stats, i);
+        }
+        printf(PIPE2 "\n");
         dept = (Dept_t *)dept->node.next;
     }
 #ifdef USE_UNICODE
-    printf("└─────────┴──────────────────────┴──────┴────────┘\n");
+    printf("└─────────┴──────────────────────┴───────┴───────┴────────┴────────┴────────────┴─────"
+           "───────┴────────────┘\n");
 #else
-    printf("+---------+----------------------+------+--------+\n");
+    printf("+---------+----------------------+-------+-------+--------+--------+------------+-----"
+           "-------+------------+\n");
 #endif
     press_any_key();
 
     return;
 }
 
-void save_depts(const char *filename)
+bool_t save_depts(const char *filename)
 {
-    FILE *file = NULL;
+    DataWriter_t writer = {0};
     uint8_t name_length = 0;
+    uint32_t count = 0;
+    uint32_t prev_id = 0;
     Dept_t *current = NULL;
 
-    file = fopen(filename, "wb");
-    if (file == NULL)
+    if (data_writer_open(&writer, filename, DEPT_FILE_MAGIC, SNAPSHOT_FLAGS) == false)
     {
         fprintf(stderr, "Error opening file for writing: %s\n", filename);
         press_any_key();
-        return;
+        return false;
     }
 
     current = (Dept_t *)Dept_Head;
     while (current != NULL)
     {
-        name_length = strnlen(current->name, DEPT_NAME_SIZE - 1) + 1;
-
-        if (fwrite(&current->id, sizeof(current->id), 1, file) != 1 ||
-            fwrite(&name_length, sizeof(name_length), 1, file) != 1 ||
-            fwrite(current->name, sizeof(char), name_length, file) != name_length)
+        if (writer.flags & DATA_FLAG_COMPACT)
         {
-            fprintf(stderr, "Error writing to file: %s\n", filename);
-            press_any_key();
-            break;
+            /* compact records drop the terminating null of the name */
+            name_length = strnlen(current->name, DEPT_NAME_SIZE - 1);
+            data_writer_put_varint(&writer, current->id - prev_id);
+            prev_id = current->id;
+        }
+        else
+        {
+            name_length = strnlen(current->name, DEPT_NAME_SIZE - 1) + 1;
+            data_writer_put(&writer, &current->id, sizeof(current->id));
         }
+        data_writer_put(&writer, &name_length, sizeof(name_length));
+        data_writer_put(&writer, current->name, name_length);
+        count++;
 
         current = (Dept_t *)current->node.next;
     }
 
-    fclose(file);
+    if (data_writer_commit(&writer, count) == false)
+    {
+        fprintf(stderr, "Error writing to file: %s\n", filename);
+        press_any_key();
+        return false;
+    }
 
-    return;
+    return true;
 }
 
-void load_depts(const char *filename)
+/****************************************************************************
+ * Name: parse_depts
+ * Input:
+ *   const char *filename  Path of the department file.
+ * Return:
+ *   None
+ * Description:
+ *   Reads the departments in `filename` into Parsed_Depts without touching
+ *   Dept_Head, so it may run on a loader thread. Errors are kept for
+ *   link_depts() to report.
+ ****************************************************************************/
+void parse_depts(const char *filename)
 {
-    FILE *file = NULL;
-    long file_length = 0;
+    DataReader_t *reader = &Parsed_Depts.reader;
     Dept_t *new_dept = NULL;
+    Dept_t **slot = NULL;
     uint8_t name_length = 0;
-
-    file = fopen(filename, "rb");
-    if (file == NULL)
+    size_t name_size = 0;
+    const uint8_t *name = NULL;
+    bool_t compact = false;
+    bool_t id_read = false;
+    uint32_t prev_id = 0;
+
+    if (parsed_table_open(&Parsed_Depts, filename, DEPT_FILE_MAGIC, sizeof(Dept_t *),
+                          DEPT_MIN_RECORD_SIZE) == false)
     {
-        fprintf(stderr, "Error opening file for reading: %s\n", filename);
-        press_any_key();
         return;
     }
+    compact = (reader->header.flags & DATA_FLAG_COMPACT) != 0;
+    /* only a hint: if it fails, pool_alloc() grows slab by slab and reports running out */
+    pool_reserve(&Dept_Pool, reader->header.record_count);
 
-    fseek(file, 0, SEEK_END);
-    file_length = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    while (ftell(file) < file_length)
+    while (data_reader_remaining(reader) > 0)
     {
-        new_dept = (Dept_t *)calloc(1, sizeof(Dept_t));
+        new_dept = (Dept_t *)pool_alloc(&Dept_Pool);
         if (new_dept == NULL)
         {
-            fprintf(stderr, "Memory allocation failed for new department\n");
-            press_any_key();
+            Parsed_Depts.error = "Memory allocation failed for new department";
             break;
         }
 
-        if (fread(&new_dept->id, sizeof(new_dept->id), 1, file) != 1 ||
-            fread(&name_length, sizeof(name_length), 1, file) != 1)
+        if (compact == true)
         {
-            free(new_dept);
-            fprintf(stderr, "Error reading department ID or Name from file: %s\n", filename);
-            press_any_key();
+            id_read = data_reader_read_varint(reader, &new_dept->id);
+            new_dept->id += prev_id;
+            prev_id = new_dept->id;
+        }
+        else
+        {
+            id_read = data_reader_read(reader, &new_dept->id, sizeof(new_dept->id));
+        }
+
+        if (id_read == false ||
+            data_reader_read(reader, &name_length, sizeof(name_length)) == false)
+        {
+            pool_free(&Dept_Pool, new_dept);
+            Parsed_Depts.error = "Error reading department ID or Name from file";
             break;
         }
 
-        if (search_sorted(new_dept->id, &match_dept, (ListNode_t *)Dept_Head) != NULL)
+        name = data_reader_take(reader, name_length);
+        name_size = (compact == true) ? name_length + 1 : name_length;
+        if (name == NULL || name_size == 0)
+        {
+            pool_free(&Dept_Pool, new_dept);
+            Parsed_Depts.error = "Error reading department data from file";
+            break;
+        }
+
+        string_copy(new_dept->name, (const char *)name,
+                    (name_size < DEPT_NAME_SIZE) ? name_size : DEPT_NAME_SIZE);
+        skip_index_init(&new_dept->student_lanes);
+        slot = (Dept_t **)parsed_table_add(&Parsed_Depts, new_dept->id);
+        if (slot == NULL)
+        {
+            pool_free(&Dept_Pool, new_dept);
+            Parsed_Depts.error = "Memory allocation failed";
+            break;
+        }
+        *slot = new_dept;
+    }
+
+    data_reader_close(reader);
+
+    return;
+}
+
+/****************************************************************************
+ * Name: link_depts
+ * Input: None
+ * Return: None
+ * Description:
+ *   Indexes the departments read by parse_depts(), discarding duplicate
+ *   IDs, and links them into Dept_Head. As for students, the file is in ID
+ *   order, so walking it backwards pushes each department at the front.
+ *   Reports any error met while parsing.
+ ****************************************************************************/
+void link_depts()
+{
+    Dept_t *dept = NULL;
+    Dept_t **loaded = (Dept_t **)Parsed_Depts.records;
+    size_t loaded_count = 0;
+
+    if (Parsed_Depts.error != NULL)
+    {
+        fprintf(stderr, "%s: %s\n", Parsed_Depts.error, Parsed_Depts.filename);
+        press_any_key();
+    }
+
+    for (size_t i = 0; i < Parsed_Depts.count; i++)
+    {
+        dept = loaded[i];
+        if (search_dept(dept->id) != NULL)
         {
             fprintf(stderr, "Department ID not unique, discarding.\n");
-            free(new_dept);
+            pool_free(&Dept_Pool, dept);
             press_any_key();
             continue;
         }
 
-        new_dept->name = (char *)malloc(name_length * sizeof(char));
-        if (new_dept->name == NULL)
+        if (dept_index_insert(dept) == false)
         {
-            free(new_dept);
             fprintf(stderr, "Memory allocation failed\n");
+            pool_free(&Dept_Pool, dept);
             press_any_key();
-            break;
+            continue;
         }
-        if (fread(new_dept->name, sizeof(char), name_length, file) != name_length)
+
+        if (dept->id >= Dept_ID)
         {
-            free(new_dept->name);
-            free(new_dept);
-            fprintf(stderr, "Error reading student data from file: %s\n", filename);
-            press_any_key();
-            break;
+            Dept_ID = dept->id + 1;
         }
-        new_dept->name[name_length - 1] = '\0';
+        loaded[loaded_count++] = dept;
+    }
 
-        insert_sorted((ListNode_t **)&Dept_Head, (ListNode_t *)new_dept, &cmp_dept);
-        if (new_dept->id >= Dept_ID)
+    for (size_t i = loaded_count; i-- > 0;)
+    {
+        if (Dept_Head != NULL && cmp_dept((ListNode_t *)loaded[i], (ListNode_t *)Dept_Head) > 0)
+        {
+            insert_sorted((ListNode_t **)&Dept_Head, (ListNode_t *)loaded[i], &cmp_dept);
+        }
+        else
         {
-            Dept_ID = new_dept->id + 1;
+            insert_front((ListNode_t **)&Dept_Head, (ListNode_t *)loaded[i]);
         }
     }
+    skip_index_build(&Dept_Lanes, (ListNode_t *)Dept_Head);
 
-    fclose(file);
+    parsed_table_free(&Parsed_Depts);
 
     return;
 }
+
+void load_depts(const char *filename)
+{
+    parse_depts(filename);
+    link_depts();
+}
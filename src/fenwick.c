@@ -0,0 +1,52 @@
+#include "fenwick.h"
+
+/*
+ * Binary indexed trees counting how many times each small integer value
+ * occurs. Slot 0 is unused so value `v` lives at position `v + 1`; each
+ * position `p` holds the count of the values in (p - lowbit(p), p].
+ */
+
+/****************************************************************************
+ * Name: fenwick_add
+ * Input:
+ *   uint32_t tree[]  Tree of `size` slots, see FENWICK_SIZE().
+ *   size_t size      Number of slots.
+ *   uint32_t value   Value whose count changes, below size - 1.
+ *   int32_t delta    Amount to add to its count, negative to remove.
+ * Return:
+ *   None
+ * Description:
+ *   O(log size).
+ ****************************************************************************/
+void fenwick_add(uint32_t tree[], size_t size, uint32_t value, int32_t delta)
+{
+    for (size_t position = (size_t)value + 1; position < size; position += position & -position)
+    {
+        tree[position] += delta;
+    }
+}
+
+/****************************************************************************
+ * Name: fenwick_count_upto
+ * Input:
+ *   const uint32_t tree[]  Tree of `size` slots.
+ *   size_t size            Number of slots.
+ *   uint32_t value         Upper bound, values above the tree's range count
+ *                          everything.
+ * Return:
+ *   uint32_t               How many values are less than or equal to `value`.
+ * Description:
+ *   O(log size).
+ ****************************************************************************/
+uint32_t fenwick_count_upto(const uint32_t tree[], size_t size, uint32_t value)
+{
+    uint32_t count = 0;
+    size_t position = (value < size - 1) ? (size_t)value + 1 : size - 1;
+
+    for (; position > 0; position -= position & -position)
+    {
+        count += tree[position];
+    }
+
+    return count;
+}
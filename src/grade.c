@@ -1,50 +1,233 @@
 #include <ctype.h>
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "common.h"
+#include "data-file.h"
+#include "dept.h"
+#include "fenwick.h"
 #include "grade.h"
 #include "heap.h"
+#include "journal.h"
 #include "student.h"
 #include "terminal-control.h"
 
-static Grade_t *update_grade(Student_t *student, uint8_t english, uint8_t math, uint8_t history);
+#define GRADE_RECORD_SIZE (sizeof(uint32_t) + 3 * sizeof(uint8_t))
+/* compact records: one-byte ID delta and the marks */
+#define GRADE_MIN_RECORD_SIZE (1 + 3 * sizeof(uint8_t))
+
+GradeTable_t Grades = {0};
+uint32_t Grade_Generation = 0;
+static ParsedTable_t Parsed_Grades = {0};
+
+/* how many graded students have each total and each subject mark */
+static uint32_t Total_Counts[FENWICK_SIZE(MAX_TOTAL)];
+static uint32_t Subject_Counts[SUBJECT_COUNT][FENWICK_SIZE(MAX_GRADE)];
+
+static bool_t reserve_grades(uint32_t capacity);
+static bool_t update_grade(Student_t *student, uint8_t english, uint8_t math, uint8_t history);
+static void count_grade(uint32_t row, int32_t delta);
+
+/****************************************************************************
+ * Name: reserve_grades
+ * Input:
+ *   uint32_t capacity  Number of rows the table must be able to hold.
+ * Return:
+ *   bool_t             false if memory allocation failed; the table stays
+ *                      usable at its old capacity.
+ ****************************************************************************/
+static bool_t reserve_grades(uint32_t capacity)
+{
+    uint8_t *english = NULL, *math = NULL, *history = NULL;
+    Student_t **owner = NULL;
+
+    if (capacity <= Grades.capacity)
+    {
+        return true;
+    }
+
+    english = (uint8_t *)realloc(Grades.english, capacity * sizeof(uint8_t));
+    if (english != NULL)
+    {
+        Grades.english = english;
+    }
+    math = (uint8_t *)realloc(Grades.math, capacity * sizeof(uint8_t));
+    if (math != NULL)
+    {
+        Grades.math = math;
+    }
+    history = (uint8_t *)realloc(Grades.history, capacity * sizeof(uint8_t));
+    if (history != NULL)
+    {
+        Grades.history = history;
+    }
+    owner = (Student_t **)realloc(Grades.owner, capacity * sizeof(Student_t *));
+    if (owner != NULL)
+    {
+        Grades.owner = owner;
+    }
+
+    if (english == NULL || math == NULL || history == NULL || owner == NULL)
+    {
+        return false;
+    }
+    Grades.capacity = capacity;
+
+    return true;
+}
 
-static Grade_t *update_grade(Student_t *student, uint8_t english, uint8_t math, uint8_t history)
+/* English, Math, History or, for SUBJECT_TOTAL, the sum of the three marks of a row */
+uint32_t grade_score(uint32_t row, int subject)
 {
+    switch (subject)
+    {
+        case 0:
+            return Grades.english[row];
+        case 1:
+            return Grades.math[row];
+        case 2:
+            return Grades.history[row];
+        default:
+            return (uint32_t)Grades.english[row] + Grades.math[row] + Grades.history[row];
+    }
+}
+
+/* adds or removes the marks of a row in the score counts */
+static void count_grade(uint32_t row, int32_t delta)
+{
+    uint32_t score = grade_score(row, SUBJECT_TOTAL);
+
+    /* marks above MAX_GRADE can only come from a foreign data file */
+    fenwick_add(Total_Counts, FENWICK_SIZE(MAX_TOTAL), (score < MAX_TOTAL) ? score : MAX_TOTAL,
+                delta);
+    for (int i = 0; i < SUBJECT_COUNT; i++)
+    {
+        score = grade_score(row, i);
+        fenwick_add(Subject_Counts[i], FENWICK_SIZE(MAX_GRADE),
+                    (score < MAX_GRADE) ? score : MAX_GRADE, delta);
+    }
+}
+
+/* number of graded students whose score in `subject` is at most `score`, O(log MAX_TOTAL) */
+uint32_t grades_at_most(int subject, uint32_t score)
+{
+    if (subject == SUBJECT_TOTAL)
+    {
+        return fenwick_count_upto(Total_Counts, FENWICK_SIZE(MAX_TOTAL), score);
+    }
+    return fenwick_count_upto(Subject_Counts[subject], FENWICK_SIZE(MAX_GRADE), score);
+}
+
+uint32_t grades_at_least(int subject, uint32_t score)
+{
+    uint32_t graded = grades_at_most(subject, MAX_TOTAL);
+
+    return (score == 0) ? graded : graded - grades_at_most(subject, score - 1);
+}
+
+static bool_t update_grade(Student_t *student, uint8_t english, uint8_t math, uint8_t history)
+{
+    uint32_t row = 0;
+    Dept_t *dept = NULL;
+
     if (student == NULL)
     {
-        return NULL;
+        return false;
     }
-    Grade_t *grade = student->grade;
-    if (grade == NULL)
+
+    dept = search_dept(student->dept_id);
+    row = student->grade_row;
+    if (row == GRADE_NONE)
     {
-        grade = (Grade_t *)calloc(1, sizeof(Grade_t));
-        if (grade == NULL)
+        if (Grades.count == Grades.capacity &&
+            reserve_grades((Grades.capacity == 0) ? 1024 : Grades.capacity * 2) == false)
         {
             fprintf(stderr, "Memory allocation failed\n");
             press_any_key();
-            return NULL;
+            return false;
         }
+        row = Grades.count++;
+        Grades.owner[row] = student;
     }
+    else
+    {
+        count_grade(row, -1);
+    }
+
+    dept_stats_apply(dept, student, -1);
+    Grades.english[row] = english;
+    Grades.math[row] = math;
+    Grades.history[row] = history;
+    student->grade_row = row;
+    dept_stats_apply(dept, student, 1);
+    count_grade(row, 1);
+    Grade_Generation++;
+
+    return true;
+}
 
-    grade->english = english;
-    grade->math = math;
-    grade->history = history;
+/****************************************************************************
+ * Name: delete_grade
+ * Input:
+ *   Student_t *student  Student whose grades are removed.
+ * Return:
+ *   None
+ * Description:
+ *   Moves the last row of the table into the student's row so the columns
+ *   stay dense. Does nothing if the student has no grades.
+ ****************************************************************************/
+void delete_grade(Student_t *student)
+{
+    uint32_t row = student->grade_row;
+    uint32_t last = 0;
+    Dept_t *dept = NULL;
 
-    student->grade = grade;
-    grade->student = student;
+    if (row == GRADE_NONE)
+    {
+        return;
+    }
 
-    return grade;
+    dept = search_dept(student->dept_id);
+    dept_stats_apply(dept, student, -1);
+    count_grade(row, -1);
+    last = --Grades.count;
+    if (row != last)
+    {
+        Grades.english[row] = Grades.english[last];
+        Grades.math[row] = Grades.math[last];
+        Grades.history[row] = Grades.history[last];
+        Grades.owner[row] = Grades.owner[last];
+        Grades.owner[row]->grade_row = row;
+    }
+    student->grade_row = GRADE_NONE;
+    dept_stats_apply(dept, student, 1);
+    Grade_Generation++;
 }
 
-void delete_grade(Grade_t *grade)
+bool_t grade_put(uint32_t student_id, uint8_t english, uint8_t math, uint8_t history)
 {
-    if (grade->student != NULL)
+    return update_grade(search_student(student_id), english, math, history);
+}
+
+void grade_remove(uint32_t student_id)
+{
+    Student_t *student = search_student(student_id);
+    if (student != NULL)
     {
-        grade->student->grade = NULL;
+        delete_grade(student);
     }
-    free(grade);
+}
+
+void cleanup_grade()
+{
+    free(Grades.english);
+    free(Grades.math);
+    free(Grades.history);
+    free(Grades.owner);
+    memset(&Grades, 0, sizeof(GradeTable_t));
+    memset(Total_Counts, 0, sizeof(Total_Counts));
+    memset(Subject_Counts, 0, sizeof(Subject_Counts));
 }
 
 void grade_from_user()
@@ -88,7 +271,10 @@ void grade_from_user()
         return;
     }
 
-    update_grade(stud, (uint8_t)english, (uint8_t)math, (uint8_t)history);
+    if (update_grade(stud, (uint8_t)english, (uint8_t)math, (uint8_t)history) == true)
+    {
+        journal_grade_put(stud);
+    }
 
     return;
 }
@@ -112,7 +298,11 @@ void delete_grade_from_user()
         return;
     }
 
-    delete_grade(stud->grade);
+    if (stud->grade_row != GRADE_NONE)
+    {
+        delete_grade(stud);
+        journal_grade_delete(id);
+    }
 
     return;
 }
@@ -150,9 +340,9 @@ void update_grade_from_user()
         return;
     }
 
-    if (stud->grade != NULL)
+    if (stud->grade_row != GRADE_NONE)
     {
-        snprintf(buffer, buffer_length, "%" PRIu8, stud->grade->english);
+        snprintf(buffer, buffer_length, "%" PRIu8, Grades.english[stud->grade_row]);
     }
     else
     {
@@ -166,9 +356,9 @@ void update_grade_from_user()
         return;
     }
 
-    if (stud->grade != NULL)
+    if (stud->grade_row != GRADE_NONE)
     {
-        snprintf(buffer, buffer_length, "%" PRIu8, stud->grade->math);
+        snprintf(buffer, buffer_length, "%" PRIu8, Grades.math[stud->grade_row]);
     }
     else
     {
@@ -182,9 +372,9 @@ void update_grade_from_user()
         return;
     }
 
-    if (stud->grade != NULL)
+    if (stud->grade_row != GRADE_NONE)
     {
-        snprintf(buffer, buffer_length, "%" PRIu8, stud->grade->history);
+        snprintf(buffer, buffer_length, "%" PRIu8, Grades.history[stud->grade_row]);
     }
     else
     {
@@ -198,7 +388,10 @@ void update_grade_from_user()
         return;
     }
 
-    update_grade(stud, (uint8_t)english, (uint8_t)math, (uint8_t)history);
+    if (update_grade(stud, (uint8_t)english, (uint8_t)math, (uint8_t)history) == true)
+    {
+        journal_grade_put(stud);
+    }
 
     free(buffer);
     return;
@@ -206,21 +399,20 @@ void update_grade_from_user()
 
 static void print_grade_row(Student_t *student)
 {
-    Grade_t *grade = NULL;
-    if (student != NULL && student->grade != NULL)
+    uint32_t row = 0;
+    if (student != NULL && student->grade_row != GRADE_NONE)
     {
-        grade = student->grade;
+        row = student->grade_row;
         printf(PIPE2 " %20s " PIPE2 " %7" PRIu8 " " PIPE2 " %7" PRIu8 " " PIPE2 " %7" PRIu8
                      " " PIPE2 "\n",
-               student->name, grade->english, grade->math, grade->history);
+               student_name(student), Grades.english[row], Grades.math[row], Grades.history[row]);
     }
     return;
 }
 
-void print_grades()
+/* the grades of the students, in the given order; students without grades are skipped */
+void print_grade_table(Student_t **students, size_t count)
 {
-    Student_t *s = NULL;
-    system("clear");
 #ifdef USE_UNICODE
     printf("┌──────────────────────┬─────────┬─────────┬─────────┐\n");
     printf("│    Student Name      │ English │   Math  │ History │\n");
@@ -231,133 +423,248 @@ void print_grades()
     printf("+----------------------+---------+---------+---------+\n");
 #endif
 
-    sorted_student_init();
-    s = sorted_student_next();
-    while (s != NULL)
+    for (size_t i = 0; i < count; i++)
     {
-        print_grade_row(s);
-        s = sorted_student_next();
+        print_grade_row(students[i]);
     }
-    sorted_student_free();
 
 #ifdef USE_UNICODE
     printf("└──────────────────────┴─────────┴─────────┴─────────┘\n");
 #else
     printf("+----------------------+---------+---------+---------+\n");
 #endif
+
+    return;
+}
+
+void print_grades()
+{
+    Student_t **students = NULL;
+    size_t student_count = 0;
+    system("clear");
+
+    if (sorted_students(&students, &student_count) == false)
+    {
+        student_count = 0;
+    }
+    print_grade_table(students, student_count);
     press_any_key();
 
     return;
 }
 
-void save_grades(const char *filename)
+bool_t save_grades(const char *filename)
 {
-    FILE *file = NULL;
+    DataWriter_t writer = {0};
+    Student_t **students = NULL;
     Student_t *student = NULL;
-    Grade_t *grade = NULL;
+    size_t student_count = 0;
+    uint32_t row = 0;
+    uint32_t count = 0;
+    uint32_t prev_id = 0;
 
-    file = fopen(filename, "wb");
-    if (file == NULL)
+    if (data_writer_open(&writer, filename, GRADE_FILE_MAGIC, SNAPSHOT_FLAGS) == false)
     {
         fprintf(stderr, "Error opening file for writing: %s\n", filename);
         press_any_key();
-        return;
+        return false;
+    }
+
+    if (sorted_students(&students, &student_count) == false)
+    {
+        data_writer_abort(&writer);
+        return false;
     }
 
-    sorted_student_init();
-    student = sorted_student_next();
-    while (student != NULL)
+    for (size_t i = 0; i < student_count; i++)
     {
-        grade = student->grade;
-        if (grade != NULL)
+        student = students[i];
+        row = student->grade_row;
+        if (row != GRADE_NONE)
         {
-            if (fwrite(&student->id, sizeof(student->id), 1, file) != 1 ||
-                fwrite(&grade->english, sizeof(grade->english), 1, file) != 1 ||
-                fwrite(&grade->math, sizeof(grade->math), 1, file) != 1 ||
-                fwrite(&grade->history, sizeof(grade->history), 1, file) != 1)
+            if (writer.flags & DATA_FLAG_COMPACT)
             {
-                fprintf(stderr, "Error writing to file: %s\n", filename);
-                press_any_key();
-                break;
+                data_writer_put_varint(&writer, student->id - prev_id);
+                prev_id = student->id;
             }
+            else
+            {
+                data_writer_put(&writer, &student->id, sizeof(student->id));
+            }
+            data_writer_put(&writer, &Grades.english[row], sizeof(uint8_t));
+            data_writer_put(&writer, &Grades.math[row], sizeof(uint8_t));
+            data_writer_put(&writer, &Grades.history[row], sizeof(uint8_t));
+            count++;
         }
-        student = sorted_student_next();
     }
-    sorted_student_free();
 
-    fclose(file);
-    return;
+    if (data_writer_commit(&writer, count) == false)
+    {
+        fprintf(stderr, "Error writing to file: %s\n", filename);
+        press_any_key();
+        return false;
+    }
+
+    return true;
 }
 
-void load_grades(const char *filename)
+/****************************************************************************
+ * Name: parse_grades
+ * Input:
+ *   const char *filename  Path of the grade file.
+ * Return:
+ *   None
+ * Description:
+ *   Reads the marks in `filename` into Parsed_Grades, keyed by student ID.
+ *   Only the parsed table is touched, so it may run on a loader thread.
+ ****************************************************************************/
+void parse_grades(const char *filename)
 {
-    FILE *file = NULL;
-    long file_length = 0;
+    DataReader_t *reader = &Parsed_Grades.reader;
     uint32_t student_id = 0;
-    Student_t *student = NULL;
-    Grade_t *new_grade = NULL;
-    size_t skip_size = 0;
+    uint32_t prev_id = 0;
+    bool_t id_read = false;
+    const uint8_t *marks = NULL;
+    uint8_t *slot = NULL;
 
-    skip_size += sizeof(new_grade->english);
-    skip_size += sizeof(new_grade->math);
-    skip_size += sizeof(new_grade->history);
-
-    file = fopen(filename, "rb");
-    if (file == NULL)
+    if (parsed_table_open(&Parsed_Grades, filename, GRADE_FILE_MAGIC, 3 * sizeof(uint8_t),
+                          GRADE_MIN_RECORD_SIZE) == false)
     {
-        fprintf(stderr, "Error opening file for reading: %s\n", filename);
-        press_any_key();
         return;
     }
 
-    fseek(file, 0, SEEK_END);
-    file_length = ftell(file);
-    fseek(file, 0, SEEK_SET);
+    /* legacy files are fixed-width, so their record count follows from the size */
+    if (reader->header.record_count == 0 &&
+        parsed_table_reserve(&Parsed_Grades, data_reader_remaining(reader) / GRADE_RECORD_SIZE) ==
+            false)
+    {
+        data_reader_close(reader);
+        return;
+    }
 
-    while (ftell(file) < file_length)
+    while (data_reader_remaining(reader) > 0)
     {
-        if (fread(&student_id, sizeof(student_id), 1, file) != 1)
+        if (reader->header.flags & DATA_FLAG_COMPACT)
         {
-            fprintf(stderr, "Error reading student ID from file: %s\n", filename);
-            press_any_key();
+            id_read = data_reader_read_varint(reader, &student_id);
+            student_id += prev_id;
+            prev_id = student_id;
+        }
+        else
+        {
+            id_read = data_reader_read(reader, &student_id, sizeof(student_id));
+        }
+
+        if (id_read == false || (marks = data_reader_take(reader, 3 * sizeof(uint8_t))) == NULL)
+        {
+            Parsed_Grades.error = "Error reading grades from file";
             break;
         }
 
-        student = search_student(student_id);
-        if (student != NULL && student->grade == NULL)
+        slot = (uint8_t *)parsed_table_add(&Parsed_Grades, student_id);
+        if (slot == NULL)
         {
-            new_grade = (Grade_t *)malloc(sizeof(Grade_t));
-            if (new_grade == NULL)
-            {
-                fprintf(stderr, "Memory allocation failed\n");
-                press_any_key();
-                break;
-            }
+            break;
+        }
+        memcpy(slot, marks, 3 * sizeof(uint8_t));
+    }
 
-            if (fread(&new_grade->english, sizeof(new_grade->english), 1, file) != 1 ||
-                fread(&new_grade->math, sizeof(new_grade->math), 1, file) != 1 ||
-                fread(&new_grade->history, sizeof(new_grade->history), 1, file) != 1)
+    data_reader_close(reader);
+
+    return;
+}
+
+/****************************************************************************
+ * Name: link_grades
+ * Input: None
+ * Return: None
+ * Description:
+ *   Attaches the grades read by parse_grades() to the loaded students. Must
+ *   run after link_students(). save_grades() writes records in ascending
+ *   student ID order, so they are merge-joined against the sorted student
+ *   view in a single pass. Records that break the order are looked up
+ *   through search_student() instead.
+ ****************************************************************************/
+void link_grades()
+{
+    uint32_t student_id = 0;
+    uint32_t last_id = 0;
+    bool_t first_record = true;
+    const uint8_t *marks = NULL;
+    Student_t **students = NULL;
+    size_t student_count = 0;
+    size_t cursor = 0;
+    Student_t *student = NULL;
+    Dept_t *dept = NULL;
+    uint32_t row = 0;
+
+    if (Parsed_Grades.error != NULL)
+    {
+        fprintf(stderr, "%s: %s\n", Parsed_Grades.error, Parsed_Grades.filename);
+        press_any_key();
+    }
+
+    if (reserve_grades(Grades.count + Parsed_Grades.count) == false)
+    {
+        parsed_table_free(&Parsed_Grades);
+        fprintf(stderr, "Memory allocation failed\n");
+        press_any_key();
+        return;
+    }
+
+    if (sorted_students(&students, &student_count) == false)
+    {
+        /* every record then takes the search_student() path */
+        first_record = false;
+        last_id = UINT32_MAX;
+    }
+
+    for (size_t i = 0; i < Parsed_Grades.count; i++)
+    {
+        student_id = Parsed_Grades.keys[i];
+        marks = (const uint8_t *)parsed_table_record(&Parsed_Grades, i);
+
+        if (first_record == true || student_id > last_id)
+        {
+            while (cursor < student_count && students[cursor]->id < student_id)
             {
-                free(new_grade);
-                fprintf(stderr, "Error reading grades from file: %s\n", filename);
-                press_any_key();
-                break;
+                cursor++;
             }
-
-            student->grade = new_grade;
+            student = (cursor < student_count && students[cursor]->id == student_id)
+                          ? students[cursor]
+                          : NULL;
+            last_id = student_id;
+            first_record = false;
         }
         else
         {
-            if (fseek(file, skip_size, SEEK_CUR) != 0)
-            {
-                fprintf(stderr, "Error seeking in file: %s\n", filename);
-                press_any_key();
-                break;
-            }
+            student = search_student(student_id);
         }
+
+        if (student == NULL || student->grade_row != GRADE_NONE)
+        {
+            continue;
+        }
+
+        dept = search_dept(student->dept_id);
+        dept_stats_apply(dept, student, -1);
+        row = Grades.count++;
+        Grades.english[row] = marks[0];
+        Grades.math[row] = marks[1];
+        Grades.history[row] = marks[2];
+        Grades.owner[row] = student;
+        student->grade_row = row;
+        dept_stats_apply(dept, student, 1);
+        count_grade(row, 1);
     }
 
-    fclose(file);
+    parsed_table_free(&Parsed_Grades);
 
     return;
-}
\ No newline at end of file
+}
+
+void load_grades(const char *filename)
+{
+    parse_grades(filename);
+    link_grades();
+}
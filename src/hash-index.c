@@ -0,0 +1,222 @@
+#include <stdlib.h>
+
+#include "hash-index.h"
+
+#define HASH_INDEX_MIN_CAPACITY 16
+
+static size_t hash_slot(const HashIndex_t *index, uint32_t key);
+static bool_t hash_index_resize(HashIndex_t *index, size_t capacity);
+
+static size_t hash_slot(const HashIndex_t *index, uint32_t key)
+{
+    /* murmur3 finalizer, spreads sequential IDs over the whole table */
+    key ^= key >> 16;
+    key *= 0x85EBCA6BU;
+    key ^= key >> 13;
+    key *= 0xC2B2AE35U;
+    key ^= key >> 16;
+    return (size_t)key & (index->capacity - 1);
+}
+
+static bool_t hash_index_resize(HashIndex_t *index, size_t capacity)
+{
+    HashIndex_t resized = {0};
+
+    resized.keys = (uint32_t *)malloc(capacity * sizeof(uint32_t));
+    resized.values = (void **)calloc(capacity, sizeof(void *));
+    if (resized.keys == NULL || resized.values == NULL)
+    {
+        free(resized.keys);
+        free(resized.values);
+        return false;
+    }
+    resized.capacity = capacity;
+
+    for (size_t i = 0; i < index->capacity; i++)
+    {
+        if (index->values[i] != NULL)
+        {
+            size_t slot = hash_slot(&resized, index->keys[i]);
+            while (resized.values[slot] != NULL)
+            {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            resized.keys[slot] = index->keys[i];
+            resized.values[slot] = index->values[i];
+            resized.count++;
+        }
+    }
+
+    free(index->keys);
+    free(index->values);
+    *index = resized;
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: hash_index_reserve
+ * Input:
+ *   HashIndex_t *index  Index to grow.
+ *   size_t count        Number of entries the index should hold without
+ *                       growing again.
+ * Return:
+ *   bool_t              false if memory allocation failed, true otherwise.
+ * Description:
+ *   Grows the table so that `count` entries stay below the 70% load factor.
+ *   Useful before bulk inserts when the number of records is known.
+ ****************************************************************************/
+bool_t hash_index_reserve(HashIndex_t *index, size_t count)
+{
+    size_t capacity = HASH_INDEX_MIN_CAPACITY;
+
+    while (capacity * 7 < count * 10)
+    {
+        capacity *= 2;
+    }
+    if (capacity <= index->capacity)
+    {
+        return true;
+    }
+
+    return hash_index_resize(index, capacity);
+}
+
+/****************************************************************************
+ * Name: hash_index_insert
+ * Input:
+ *   HashIndex_t *index  Index to insert into.
+ *   uint32_t key        Key of the entry.
+ *   void *value         Value stored for the key, must not be NULL.
+ * Return:
+ *   bool_t              false if `value` is NULL or memory allocation failed.
+ * Description:
+ *   Inserts the key into the open-addressing (linear probing) table, replacing
+ *   the value if the key is already present.
+ ****************************************************************************/
+bool_t hash_index_insert(HashIndex_t *index, uint32_t key, void *value)
+{
+    size_t slot = 0;
+
+    if (index == NULL || value == NULL)
+    {
+        return false;
+    }
+
+    if (hash_index_reserve(index, index->count + 1) == false)
+    {
+        return false;
+    }
+
+    slot = hash_slot(index, key);
+    while (index->values[slot] != NULL)
+    {
+        if (index->keys[slot] == key)
+        {
+            index->values[slot] = value;
+            return true;
+        }
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+
+    index->keys[slot] = key;
+    index->values[slot] = value;
+    index->count++;
+
+    return true;
+}
+
+void *hash_index_find(const HashIndex_t *index, uint32_t key)
+{
+    size_t slot = 0;
+
+    if (index == NULL || index->count == 0)
+    {
+        return NULL;
+    }
+
+    slot = hash_slot(index, key);
+    while (index->values[slot] != NULL)
+    {
+        if (index->keys[slot] == key)
+        {
+            return index->values[slot];
+        }
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+ * Name: hash_index_remove
+ * Input:
+ *   HashIndex_t *index  Index to remove from.
+ *   uint32_t key        Key of the entry to remove.
+ * Return:
+ *   None
+ * Description:
+ *   Removes the key if present. Entries following it in the probe sequence
+ *   are shifted back, so the table never needs tombstones.
+ ****************************************************************************/
+void hash_index_remove(HashIndex_t *index, uint32_t key)
+{
+    size_t mask = 0;
+    size_t hole = 0;
+    size_t slot = 0;
+    size_t home = 0;
+
+    if (index == NULL || index->count == 0)
+    {
+        return;
+    }
+
+    mask = index->capacity - 1;
+    hole = hash_slot(index, key);
+    while (index->values[hole] != NULL && index->keys[hole] != key)
+    {
+        hole = (hole + 1) & mask;
+    }
+    if (index->values[hole] == NULL)
+    {
+        return;
+    }
+
+    slot = hole;
+    while (true)
+    {
+        slot = (slot + 1) & mask;
+        if (index->values[slot] == NULL)
+        {
+            break;
+        }
+
+        /* move the entry back if the hole lies between its home slot and itself */
+        home = hash_slot(index, index->keys[slot]);
+        if (((slot - home) & mask) >= ((slot - hole) & mask))
+        {
+            index->keys[hole] = index->keys[slot];
+            index->values[hole] = index->values[slot];
+            hole = slot;
+        }
+    }
+
+    index->values[hole] = NULL;
+    index->count--;
+
+    return;
+}
+
+void hash_index_free(HashIndex_t *index)
+{
+    if (index == NULL)
+    {
+        return;
+    }
+    free(index->keys);
+    free(index->values);
+    index->keys = NULL;
+    index->values = NULL;
+    index->capacity = 0;
+    index->count = 0;
+}
@@ -1,118 +1,414 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "dept.h"
 #include "grade.h"
 #include "heap.h"
 #include "student.h"
 #include "terminal-control.h"
+#include "typed-list.h"
 
-static Student_t **Heap_Array = NULL;
-static int Heap_Size = 0;
+DEFINE_TYPED_HEAP(student, Student_t, id)
 
-static void min_heapify(Student_t *heap[], int size, int i,
-                        int (*cmp_func)(ListNode_t *, ListNode_t *));
-static void build_min_heap(Student_t *heap[], int size,
-                           int (*cmp_func)(ListNode_t *, ListNode_t *));
+/*
+ * Every student in ascending ID order. It is built from the k-way merge of
+ * the student lists on first use, then kept in step by student_put() and
+ * student_remove(). Moving a student between departments does not change
+ * the ID order, so only additions and deletions patch it; bulk changes
+ * drop it with sorted_view_invalidate().
+ */
+static Student_t **Sorted_View = NULL;
+static size_t Sorted_View_Count = 0;
+static size_t Sorted_View_Capacity = 0;
+static bool_t Sorted_View_Valid = false;
 
-static void min_heapify(Student_t *heap[], int size, int i,
-                        int (*cmp_func)(ListNode_t *, ListNode_t *))
+static bool_t reserve_sorted_view(size_t capacity);
+static bool_t build_sorted_view();
+static size_t sorted_view_position(uint32_t id);
+static void entry_sift_down(HeapEntry_t entries[], size_t size, size_t i);
+
+/****************************************************************************
+ * Name: student_iter_init
+ * Input:
+ *   StudentIter_t *iter     Iterator to initialise.
+ *   uint32_t start_id       Students with a smaller ID are skipped.
+ *   StudentFilter_t filter  Students it rejects are skipped, NULL for none.
+ *   void *context           Passed to `filter`.
+ * Return:
+ *   bool_t                  false if memory allocation failed.
+ * Description:
+ *   Positions the iterator on the first student with ID `start_id` or
+ *   above. When the sorted view is current the iterator walks it from a
+ *   binary-search seek; otherwise it merges the student lists through its
+ *   own heap of list cursors, each walked from its head up to `start_id`.
+ *   Callers that seek should make sure the view is built with
+ *   sorted_students(). Call student_iter_free() when done.
+ ****************************************************************************/
+bool_t student_iter_init(StudentIter_t *iter, uint32_t start_id, StudentFilter_t filter,
+                         void *context)
 {
-    int smallest = i;
-    int left = 2 * i + 1;
-    int right = 2 * i + 2;
+    Dept_t *dept = Dept_Head;
+    Student_t *cursor = NULL;
+    int list_count = 1;
+
+    memset(iter, 0, sizeof(StudentIter_t));
+    iter->filter = filter;
+    iter->context = context;
 
-    if (left < size && cmp_func((ListNode_t *)heap[left], (ListNode_t *)heap[smallest]) < 0)
-        smallest = left;
+    if (Sorted_View_Valid == true)
+    {
+        iter->view_pos = sorted_view_position(start_id);
+        return true;
+    }
 
-    if (right < size && cmp_func((ListNode_t *)heap[right], (ListNode_t *)heap[smallest]) < 0)
-        smallest = right;
+    while (dept != NULL)
+    {
+        list_count++;
+        dept = (Dept_t *)dept->node.next;
+    }
+
+    iter->heap = iter->inline_heap;
+    if (list_count > STUDENT_ITER_INLINE)
+    {
+        iter->heap = (Student_t **)malloc(list_count * sizeof(Student_t *));
+        if (iter->heap == NULL)
+        {
+            return false;
+        }
+    }
 
-    if (smallest != i)
+    cursor = Student_Head;
+    dept = Dept_Head;
+    for (int i = 0; i < list_count; i++)
     {
-        Student_t *temp = heap[i];
-        heap[i] = heap[smallest];
-        heap[smallest] = temp;
-        min_heapify(heap, size, smallest, cmp_func);
+        while (cursor != NULL && cursor->id < start_id)
+        {
+            cursor = (Student_t *)cursor->node.next;
+        }
+        if (cursor != NULL)
+        {
+            iter->heap[iter->size++] = cursor;
+        }
+        if (dept != NULL)
+        {
+            cursor = dept->students;
+            dept = (Dept_t *)dept->node.next;
+        }
     }
+
+    student_build_min_heap(iter->heap, iter->size);
+
+    return true;
+}
+
+Student_t *student_iter_next(StudentIter_t *iter)
+{
+    Student_t *student = NULL;
+
+    do
+    {
+        if (iter->heap == NULL)
+        {
+            if (iter->view_pos >= Sorted_View_Count)
+            {
+                return NULL;
+            }
+            student = Sorted_View[iter->view_pos++];
+            continue;
+        }
+
+        if (iter->size == 0)
+        {
+            return NULL;
+        }
+        student = iter->heap[0];
+        if (student->node.next != NULL)
+        {
+            iter->heap[0] = (Student_t *)student->node.next;
+        }
+        else
+        {
+            iter->heap[0] = iter->heap[--iter->size];
+        }
+        student_min_heapify(iter->heap, iter->size, 0);
+    } while (iter->filter != NULL && iter->filter(student, iter->context) == false);
+
+    return student;
 }
 
-static void build_min_heap(Student_t *heap[], int size, int (*cmp_func)(ListNode_t *, ListNode_t *))
+void student_iter_free(StudentIter_t *iter)
 {
-    for (int i = size / 2 - 1; i >= 0; i--)
+    if (iter->heap != NULL && iter->heap != iter->inline_heap)
     {
-        min_heapify(heap, size, i, cmp_func);
+        free(iter->heap);
     }
+    iter->heap = NULL;
+    iter->size = 0;
 }
 
-void sorted_student_init()
+static bool_t reserve_sorted_view(size_t capacity)
 {
-    sorted_student_free();
+    Student_t **view = NULL;
 
-    Dept_t *dept = Dept_Head;
-    int dept_count = 1;
+    if (capacity <= Sorted_View_Capacity)
+    {
+        return true;
+    }
+    view = (Student_t **)realloc(Sorted_View, capacity * sizeof(Student_t *));
+    if (view == NULL)
+    {
+        return false;
+    }
+    Sorted_View = view;
+    Sorted_View_Capacity = capacity;
 
-    while (dept != NULL)
+    return true;
+}
+
+static bool_t build_sorted_view()
+{
+    StudentIter_t iter;
+    Student_t *student = NULL;
+
+    Sorted_View_Count = 0;
+    if (student_iter_init(&iter, 0, NULL, NULL) == false)
     {
-        dept_count++;
-        dept = (Dept_t *)dept->node.next;
+        return false;
     }
+    student = student_iter_next(&iter);
+    while (student != NULL)
+    {
+        if (Sorted_View_Count == Sorted_View_Capacity &&
+            reserve_sorted_view((Sorted_View_Capacity == 0) ? 1024 : Sorted_View_Capacity * 2) ==
+                false)
+        {
+            student_iter_free(&iter);
+            return false;
+        }
+        Sorted_View[Sorted_View_Count++] = student;
+        student = student_iter_next(&iter);
+    }
+    student_iter_free(&iter);
+    Sorted_View_Valid = true;
+
+    return true;
+}
+
+/* index of the first student in the view whose ID is not below `id` */
+static size_t sorted_view_position(uint32_t id)
+{
+    size_t low = 0;
+    size_t high = Sorted_View_Count;
+    size_t mid = 0;
 
-    if (dept_count == 0)
+    while (low < high)
     {
-        Heap_Array = NULL;
-        Heap_Size = 0;
-        return;
+        mid = low + (high - low) / 2;
+        if (Sorted_View[mid]->id < id)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
     }
 
-    Heap_Array = (Student_t **)malloc(dept_count * sizeof(Student_t *));
-    if (Heap_Array == NULL)
+    return low;
+}
+
+/****************************************************************************
+ * Name: sorted_students
+ * Input:
+ *   Student_t ***students  Receives the students in ascending ID order.
+ *   size_t *count          Receives the number of students.
+ * Return:
+ *   bool_t                 false if the view could not be built for lack of
+ *                          memory; callers must not mistake that for an
+ *                          empty table.
+ * Description:
+ *   Returns the cached ID-ordered view, building it first if needed. The
+ *   array stays valid until the next student is added or removed.
+ ****************************************************************************/
+bool_t sorted_students(Student_t ***students, size_t *count)
+{
+    if (Sorted_View_Valid == false && build_sorted_view() == false)
     {
         fprintf(stderr, "Memory allocation failed\n");
         press_any_key();
-        return;
+        return false;
     }
 
-    Heap_Size = dept_count;
+    *students = Sorted_View;
+    *count = Sorted_View_Count;
 
-    Heap_Array[0] = Student_Head;
-    dept = Dept_Head;
-    for (int i = 1; i < dept_count; i++)
+    return true;
+}
+
+void sorted_view_insert(Student_t *student)
+{
+    size_t position = 0;
+
+    if (Sorted_View_Valid == false)
     {
-        Heap_Array[i] = dept->students;
-        dept = (Dept_t *)dept->node.next;
+        return;
+    }
+    if (Sorted_View_Count == Sorted_View_Capacity &&
+        reserve_sorted_view(Sorted_View_Capacity * 2 + 1) == false)
+    {
+        Sorted_View_Valid = false;
+        return;
     }
 
-    build_min_heap(Heap_Array, Heap_Size, cmp_student);
+    position = sorted_view_position(student->id);
+    memmove(&Sorted_View[position + 1], &Sorted_View[position],
+            (Sorted_View_Count - position) * sizeof(Student_t *));
+    Sorted_View[position] = student;
+    Sorted_View_Count++;
 }
 
-Student_t *sorted_student_next()
+void sorted_view_remove(Student_t *student)
 {
-    if (Heap_Size == 0 || Heap_Array == NULL)
-        return NULL;
+    size_t position = 0;
 
-    Student_t *min_student = Heap_Array[0];
+    if (Sorted_View_Valid == false)
+    {
+        return;
+    }
 
-    if (min_student != NULL && min_student->node.next)
+    position = sorted_view_position(student->id);
+    if (position < Sorted_View_Count && Sorted_View[position] == student)
     {
-        Heap_Array[0] = (Student_t *)min_student->node.next;
+        memmove(&Sorted_View[position], &Sorted_View[position + 1],
+                (Sorted_View_Count - position - 1) * sizeof(Student_t *));
+        Sorted_View_Count--;
     }
-    else
+}
+
+void sorted_view_invalidate()
+{
+    Sorted_View_Valid = false;
+}
+
+void sorted_view_free()
+{
+    free(Sorted_View);
+    Sorted_View = NULL;
+    Sorted_View_Count = 0;
+    Sorted_View_Capacity = 0;
+    Sorted_View_Valid = false;
+}
+
+static void entry_sift_down(HeapEntry_t entries[], size_t size, size_t i)
+{
+    HeapEntry_t entry = entries[i];
+    size_t child = 0;
+
+    while ((child = 2 * i + 1) < size)
     {
-        Heap_Array[0] = Heap_Array[--Heap_Size];
+        if (child + 1 < size && entries[child + 1].key < entries[child].key)
+        {
+            child++;
+        }
+        if (entries[child].key >= entry.key)
+        {
+            break;
+        }
+        entries[i] = entries[child];
+        i = child;
     }
+    entries[i] = entry;
+}
 
-    min_heapify(Heap_Array, Heap_Size, 0, cmp_student);
+/****************************************************************************
+ * Name: bounded_heap_init
+ * Input:
+ *   BoundedHeap_t *heap  Heap to initialise.
+ *   size_t capacity      Number of entries to keep.
+ * Return:
+ *   bool_t               false if memory allocation failed.
+ ****************************************************************************/
+bool_t bounded_heap_init(BoundedHeap_t *heap, size_t capacity)
+{
+    heap->size = 0;
+    heap->capacity = capacity;
+    heap->entries = (HeapEntry_t *)malloc(((capacity > 0) ? capacity : 1) * sizeof(HeapEntry_t));
 
-    return min_student;
+    return heap->entries != NULL;
 }
 
-void sorted_student_free()
+/****************************************************************************
+ * Name: bounded_heap_offer
+ * Input:
+ *   BoundedHeap_t *heap  Heap to offer the item to.
+ *   uint64_t key         Rank of the item.
+ *   void *item           Item to keep if it ranks among the best.
+ * Return:
+ *   None
+ * Description:
+ *   Adds the item while the heap is not full; afterwards it replaces the
+ *   root if its key is larger. O(log K) for a heap of capacity K, and O(1)
+ *   for the common case of an item that does not make the cut.
+ ****************************************************************************/
+void bounded_heap_offer(BoundedHeap_t *heap, uint64_t key, void *item)
 {
-    if (Heap_Array != NULL)
+    HeapEntry_t *entries = heap->entries;
+    size_t i = 0;
+
+    if (heap->size < heap->capacity)
     {
-        free(Heap_Array);
+        /* sift up */
+        i = heap->size++;
+        while (i > 0 && entries[(i - 1) / 2].key > key)
+        {
+            entries[i] = entries[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        entries[i].key = key;
+        entries[i].item = item;
+        return;
+    }
+
+    if (heap->capacity == 0 || key <= entries[0].key)
+    {
+        return;
     }
-    Heap_Array = NULL;
-    Heap_Size = 0;
+    entries[0].key = key;
+    entries[0].item = item;
+    entry_sift_down(entries, heap->size, 0);
+}
+
+/****************************************************************************
+ * Name: bounded_heap_sort
+ * Input:
+ *   BoundedHeap_t *heap  Heap to sort.
+ * Return:
+ *   size_t               Number of entries.
+ * Description:
+ *   Sorts the kept entries in place by descending key, best first. The
+ *   entries are no longer a heap afterwards, so nothing may be offered.
+ ****************************************************************************/
+size_t bounded_heap_sort(BoundedHeap_t *heap)
+{
+    HeapEntry_t *entries = heap->entries;
+    HeapEntry_t temp;
+
+    for (size_t last = heap->size; last-- > 1;)
+    {
+        temp = entries[0];
+        entries[0] = entries[last];
+        entries[last] = temp;
+        entry_sift_down(entries, last, 0);
+    }
+
+    return heap->size;
+}
+
+void bounded_heap_free(BoundedHeap_t *heap)
+{
+    free(heap->entries);
+    heap->entries = NULL;
+    heap->size = 0;
+    heap->capacity = 0;
 }
@@ -0,0 +1,420 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "common.h"
+#include "data-file.h"
+#include "dept.h"
+#include "grade.h"
+#include "journal.h"
+#include "student.h"
+#include "terminal-control.h"
+
+/*
+ * The journal records every committed change as an idempotent "put" or
+ * "delete" of one department, student or grade. Changes are buffered in
+ * memory and appended to the journal file by "Save Data" as one batch:
+ *
+ *   uint32_t payload_size, uint32_t checksum, payload_size bytes of records
+ *
+ * Replaying the journal on top of the snapshot files reproduces the saved
+ * state, so saving only costs as much as the number of changes. Once the
+ * journal grows past JOURNAL_COMPACT_SIZE it is folded back into the
+ * snapshots by save_database().
+ */
+
+#define JOURNAL_COMPACT_SIZE (1 << 20)
+#define JOURNAL_FRAME_SIZE (2 * sizeof(uint32_t))
+#define JOURNAL_MIN_CAPACITY 4096
+
+typedef enum JournalOp
+{
+    JOURNAL_DEPT_PUT = 1,
+    JOURNAL_DEPT_DELETE,
+    JOURNAL_STUDENT_PUT,
+    JOURNAL_STUDENT_DELETE,
+    JOURNAL_GRADE_PUT,
+    JOURNAL_GRADE_DELETE
+} JournalOp_t;
+
+static uint8_t *Journal_Buffer = NULL;
+static size_t Journal_Capacity = 0;
+static size_t Journal_Pending = 0;
+static size_t Journal_File_Size = 0;
+static bool_t Journal_Overflow = false;
+
+static void journal_put(const void *data, size_t size);
+static void journal_put_op(JournalOp_t op, uint32_t id);
+static void journal_put_name(const char *name, size_t max_size);
+static bool_t journal_apply(DataReader_t *batch);
+static void journal_rollback(int fd, off_t size, const char *filename);
+
+static void journal_put(const void *data, size_t size)
+{
+    size_t capacity = 0;
+    uint8_t *temp = NULL;
+
+    if (Journal_Overflow == true)
+    {
+        return;
+    }
+
+    if (JOURNAL_FRAME_SIZE + Journal_Pending + size > Journal_Capacity)
+    {
+        capacity = (Journal_Capacity == 0) ? JOURNAL_MIN_CAPACITY : Journal_Capacity;
+        while (JOURNAL_FRAME_SIZE + Journal_Pending + size > capacity)
+        {
+            capacity *= 2;
+        }
+        temp = (uint8_t *)realloc(Journal_Buffer, capacity);
+        if (temp == NULL)
+        {
+            /* the changes are still in memory, the next save writes full snapshots */
+            Journal_Overflow = true;
+            return;
+        }
+        Journal_Buffer = temp;
+        Journal_Capacity = capacity;
+    }
+
+    memcpy(Journal_Buffer + JOURNAL_FRAME_SIZE + Journal_Pending, data, size);
+    Journal_Pending += size;
+}
+
+static void journal_put_op(JournalOp_t op, uint32_t id)
+{
+    uint8_t op_code = (uint8_t)op;
+
+    journal_put(&op_code, sizeof(op_code));
+    journal_put(&id, sizeof(id));
+}
+
+static void journal_put_name(const char *name, size_t max_size)
+{
+    uint8_t name_length = strnlen(name, max_size - 1) + 1;
+
+    journal_put(&name_length, sizeof(name_length));
+    journal_put(name, name_length - 1);
+    journal_put("", 1);
+}
+
+void journal_dept_put(const Dept_t *dept)
+{
+    journal_put_op(JOURNAL_DEPT_PUT, dept->id);
+    journal_put_name(dept->name, DEPT_NAME_SIZE);
+}
+
+void journal_dept_delete(uint32_t id)
+{
+    journal_put_op(JOURNAL_DEPT_DELETE, id);
+}
+
+void journal_student_put(const Student_t *student)
+{
+    journal_put_op(JOURNAL_STUDENT_PUT, student->id);
+    journal_put_name(student_name(student), STUDENT_NAME_SIZE);
+    journal_put(&student->gender, sizeof(student->gender));
+    journal_put(&student->dept_id, sizeof(student->dept_id));
+}
+
+void journal_student_delete(uint32_t id)
+{
+    journal_put_op(JOURNAL_STUDENT_DELETE, id);
+}
+
+void journal_grade_put(const Student_t *student)
+{
+    uint32_t row = student->grade_row;
+
+    journal_put_op(JOURNAL_GRADE_PUT, student->id);
+    journal_put(&Grades.english[row], sizeof(uint8_t));
+    journal_put(&Grades.math[row], sizeof(uint8_t));
+    journal_put(&Grades.history[row], sizeof(uint8_t));
+}
+
+void journal_grade_delete(uint32_t student_id)
+{
+    journal_put_op(JOURNAL_GRADE_DELETE, student_id);
+}
+
+bool_t journal_should_compact()
+{
+    return Journal_Overflow == true ||
+           Journal_File_Size + JOURNAL_FRAME_SIZE + Journal_Pending > JOURNAL_COMPACT_SIZE;
+}
+
+/* cuts a failed append off again; if that fails too, replay drops the torn batch */
+static void journal_rollback(int fd, off_t size, const char *filename)
+{
+    if (ftruncate(fd, size) == -1)
+    {
+        fprintf(stderr, "Error truncating journal file: %s\n", filename);
+        press_any_key();
+    }
+    close(fd);
+}
+
+/****************************************************************************
+ * Name: journal_flush
+ * Input:
+ *   const char *filename  Path of the journal file.
+ * Return:
+ *   bool_t                false if the pending changes could not be made
+ *                         durable; they stay buffered in that case.
+ * Description:
+ *   Appends the changes buffered since the last save to the journal as one
+ *   checksummed batch and fsyncs it. A failed append is cut off again, so
+ *   the file never holds a partial batch in front of later ones.
+ ****************************************************************************/
+bool_t journal_flush(const char *filename)
+{
+    int fd = -1;
+    struct stat st = {0};
+    DataHeader_t header = {0};
+    uint32_t frame[2] = {0};
+    size_t batch_size = 0;
+
+    if (Journal_Overflow == true)
+    {
+        return false;
+    }
+    if (Journal_Pending == 0)
+    {
+        return true;
+    }
+
+    fd = open(filename, O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd == -1 || fstat(fd, &st) == -1)
+    {
+        if (fd != -1)
+        {
+            close(fd);
+        }
+        return false;
+    }
+
+    if (st.st_size == 0)
+    {
+        header.magic = JOURNAL_FILE_MAGIC;
+        header.version = DATA_FILE_VERSION;
+        if (write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header))
+        {
+            journal_rollback(fd, 0, filename);
+            return false;
+        }
+        st.st_size = sizeof(header);
+    }
+
+    frame[0] = (uint32_t)Journal_Pending;
+    frame[1] = data_checksum(Journal_Buffer + JOURNAL_FRAME_SIZE, Journal_Pending);
+    memcpy(Journal_Buffer, frame, JOURNAL_FRAME_SIZE);
+    batch_size = JOURNAL_FRAME_SIZE + Journal_Pending;
+
+    if (write(fd, Journal_Buffer, batch_size) != (ssize_t)batch_size || fsync(fd) == -1)
+    {
+        journal_rollback(fd, st.st_size, filename);
+        return false;
+    }
+    close(fd);
+
+    Journal_File_Size = (size_t)st.st_size + batch_size;
+    Journal_Pending = 0;
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: journal_reset
+ * Input:
+ *   const char *filename  Path of the journal file.
+ * Return:
+ *   None
+ * Description:
+ *   Drops the journal once its changes are part of freshly written
+ *   snapshots, together with any changes still waiting in the buffer.
+ ****************************************************************************/
+void journal_reset(const char *filename)
+{
+    if (unlink(filename) == -1 && errno != ENOENT)
+    {
+        fprintf(stderr, "Error removing journal file: %s\n", filename);
+        press_any_key();
+    }
+    Journal_File_Size = 0;
+    Journal_Pending = 0;
+    Journal_Overflow = false;
+}
+
+static bool_t journal_apply(DataReader_t *batch)
+{
+    uint8_t op = 0;
+    uint32_t id = 0;
+    uint32_t dept_id = 0;
+    uint8_t name_length = 0;
+    const uint8_t *name = NULL;
+    char name_buffer[UINT8_MAX + 1];
+    char gender = '\0';
+    const uint8_t *marks = NULL;
+
+    if (data_reader_read(batch, &op, sizeof(op)) == false ||
+        data_reader_read(batch, &id, sizeof(id)) == false)
+    {
+        return false;
+    }
+
+    if (op == JOURNAL_DEPT_PUT || op == JOURNAL_STUDENT_PUT)
+    {
+        if (data_reader_read(batch, &name_length, sizeof(name_length)) == false ||
+            name_length == 0 || (name = data_reader_take(batch, name_length)) == NULL)
+        {
+            return false;
+        }
+        memcpy(name_buffer, name, name_length);
+        name_buffer[name_length - 1] = '\0';
+    }
+
+    switch (op)
+    {
+        case JOURNAL_DEPT_PUT:
+            dept_put(id, name_buffer);
+            break;
+        case JOURNAL_DEPT_DELETE:
+            dept_remove(id);
+            break;
+        case JOURNAL_STUDENT_PUT:
+            if (data_reader_read(batch, &gender, sizeof(gender)) == false ||
+                data_reader_read(batch, &dept_id, sizeof(dept_id)) == false)
+            {
+                return false;
+            }
+            student_put(id, name_buffer, gender, search_dept(dept_id));
+            break;
+        case JOURNAL_STUDENT_DELETE:
+            student_remove(id);
+            break;
+        case JOURNAL_GRADE_PUT:
+            marks = data_reader_take(batch, 3 * sizeof(uint8_t));
+            if (marks == NULL)
+            {
+                return false;
+            }
+            grade_put(id, marks[0], marks[1], marks[2]);
+            break;
+        case JOURNAL_GRADE_DELETE:
+            grade_remove(id);
+            break;
+        default:
+            return false;
+    }
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: journal_replay
+ * Input:
+ *   const char *filename  Path of the journal file.
+ * Return:
+ *   None
+ * Description:
+ *   Applies the journal on top of the loaded snapshots. A missing journal
+ *   means there is nothing to replay. A batch cut short by a crash is
+ *   dropped and truncated away so that later saves append after the last
+ *   complete batch. A journal that can not be read at all, or a batch
+ *   that passes its checksum but can not be applied, stops the replay and
+ *   marks the journal unusable, so the next save rewrites the snapshots
+ *   and drops the file instead of appending changes that would never be
+ *   replayed.
+ ****************************************************************************/
+void journal_replay(const char *filename)
+{
+    DataReader_t reader = {0};
+    DataReader_t batch = {0};
+    DataHeader_t header = {0};
+    uint32_t frame[2] = {0};
+    size_t valid_size = 0;
+    bool_t malformed = false;
+
+    Journal_File_Size = 0;
+    if (access(filename, F_OK) == -1)
+    {
+        return;
+    }
+
+    if (data_reader_open(&reader, filename) == false)
+    {
+        fprintf(stderr, "Error opening file for reading: %s\n", filename);
+        press_any_key();
+        return;
+    }
+
+    if (data_reader_read(&reader, &header, sizeof(header)) == false ||
+        header.magic != JOURNAL_FILE_MAGIC || header.version > DATA_FILE_VERSION)
+    {
+        data_reader_close(&reader);
+        Journal_Overflow = true;
+        fprintf(stderr, "Unsupported journal file, not replayed: %s\n", filename);
+        press_any_key();
+        return;
+    }
+
+    valid_size = reader.pos;
+    while (data_reader_remaining(&reader) > 0)
+    {
+        if (data_reader_read(&reader, frame, sizeof(frame)) == false ||
+            (batch.data = data_reader_take(&reader, frame[0])) == NULL ||
+            data_checksum(batch.data, frame[0]) != frame[1])
+        {
+            fprintf(stderr, "Incomplete change batch at the end of the journal, discarding.\n");
+            press_any_key();
+            break;
+        }
+
+        batch.size = frame[0];
+        batch.pos = 0;
+        while (malformed == false && data_reader_remaining(&batch) > 0)
+        {
+            malformed = (journal_apply(&batch) == false);
+        }
+        if (malformed == true)
+        {
+            break;
+        }
+        valid_size = reader.pos;
+    }
+
+    if (malformed == true)
+    {
+        /* the file is left as it is; the next save replaces it */
+        Journal_Overflow = true;
+        Journal_File_Size = valid_size;
+        data_reader_close(&reader);
+        fprintf(stderr, "Malformed change in journal file, later changes not replayed: %s\n",
+                filename);
+        press_any_key();
+        return;
+    }
+
+    if (valid_size < reader.size && truncate(filename, (off_t)valid_size) == -1)
+    {
+        fprintf(stderr, "Error truncating journal file: %s\n", filename);
+        press_any_key();
+    }
+    Journal_File_Size = valid_size;
+
+    data_reader_close(&reader);
+
+    return;
+}
+
+void cleanup_journal()
+{
+    free(Journal_Buffer);
+    Journal_Buffer = NULL;
+    Journal_Capacity = 0;
+    Journal_Pending = 0;
+}
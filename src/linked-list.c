@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "linked-list.h"
 
@@ -24,15 +25,15 @@ void delete_node(ListNode_t **head, ListNode_t *node, void (*free_data)(ListNode
         if (node->prev != NULL)
         {
             node->prev->next = node->next;
-            node->prev = NULL;
         }
 
         if (node->next != NULL)
         {
             node->next->prev = node->prev;
-            node->next = NULL;
         }
     }
+    node->prev = NULL;
+    node->next = NULL;
 
     if (free_data != NULL)
     {
@@ -133,6 +134,24 @@ void insert_sorted(ListNode_t **head, ListNode_t *new_node,
     return;
 }
 
+void insert_front(ListNode_t **head, ListNode_t *new_node)
+{
+    if (head == NULL || new_node == NULL)
+    {
+        return;
+    }
+
+    new_node->prev = NULL;
+    new_node->next = *head;
+    if (*head != NULL)
+    {
+        (*head)->prev = new_node;
+    }
+    *head = new_node;
+
+    return;
+}
+
 void merge_sorted(ListNode_t **head1, ListNode_t *head2,
                   int32_t (*cmp_func)(ListNode_t *, ListNode_t *))
 {
@@ -200,3 +219,279 @@ void merge_sorted(ListNode_t **head1, ListNode_t *head2,
 
     return;
 }
+
+static int skip_random_level(SkipIndex_t *index);
+static ListNode_t *skip_descend(SkipIndex_t *index, ListNode_t *key_node, uint32_t key,
+                                int32_t (*cmp_func)(ListNode_t *, ListNode_t *),
+                                int32_t (*match_func)(ListNode_t *, uint32_t),
+                                SkipLane_t **update);
+
+void skip_index_init(SkipIndex_t *index)
+{
+    SkipIndex_t empty = SKIP_INDEX_INITIALIZER;
+
+    *index = empty;
+}
+
+/* drops every lane, the list itself is left untouched */
+void skip_index_free(SkipIndex_t *index)
+{
+    pool_release(&index->pool);
+    memset(index->lanes, 0, sizeof(index->lanes));
+    index->levels = 0;
+}
+
+/* each lane is four times sparser than the one below it */
+static int skip_random_level(SkipIndex_t *index)
+{
+    int level = 0;
+
+    index->seed ^= index->seed << 13;
+    index->seed ^= index->seed >> 17;
+    index->seed ^= index->seed << 5;
+    for (uint32_t bits = index->seed; (bits & 3) == 0 && level < SKIP_MAX_LEVEL; bits >>= 2)
+    {
+        level++;
+    }
+
+    return level;
+}
+
+/****************************************************************************
+ * Name: skip_index_build
+ * Input:
+ *   SkipIndex_t *index  Index to rebuild.
+ *   ListNode_t *head    Sorted list it covers.
+ * Return:
+ *   None
+ * Description:
+ *   Replaces the lanes of `index` with evenly spaced ones over `head`: every
+ *   4th node on the lowest lane, every 16th on the next, and so on. Used
+ *   after the list was linked or merged without going through the index.
+ *   If memory runs out the upper lanes are left shorter, which only makes
+ *   searches slower.
+ ****************************************************************************/
+void skip_index_build(SkipIndex_t *index, ListNode_t *head)
+{
+    SkipLane_t *tails[SKIP_MAX_LEVEL] = {NULL};
+    SkipLane_t *lane = NULL;
+    SkipLane_t *below = NULL;
+    size_t position = 0;
+
+    skip_index_free(index);
+
+    for (ListNode_t *node = head; node != NULL; node = node->next)
+    {
+        below = NULL;
+        position++;
+        for (int level = 0; level < SKIP_MAX_LEVEL && position % ((size_t)4 << (2 * level)) == 0;
+             level++)
+        {
+            lane = (SkipLane_t *)pool_alloc(&index->pool);
+            if (lane == NULL)
+            {
+                break;
+            }
+            lane->node = node;
+            lane->down = below;
+            if (tails[level] == NULL)
+            {
+                index->lanes[level] = lane;
+            }
+            else
+            {
+                tails[level]->next = lane;
+            }
+            tails[level] = lane;
+            below = lane;
+            if (level >= index->levels)
+            {
+                index->levels = level + 1;
+            }
+        }
+    }
+
+    return;
+}
+
+/*
+ * Walks the lanes down towards the key, which is `key_node` when cmp_func
+ * is given and `key` through match_func otherwise. update[level] is left
+ * at the last lane node before the key on each lane, NULL if there is none.
+ * Returns the list node to continue from, NULL to start at the head.
+ */
+static ListNode_t *skip_descend(SkipIndex_t *index, ListNode_t *key_node, uint32_t key,
+                                int32_t (*cmp_func)(ListNode_t *, ListNode_t *),
+                                int32_t (*match_func)(ListNode_t *, uint32_t),
+                                SkipLane_t **update)
+{
+    SkipLane_t *lane = NULL;
+    SkipLane_t *next = NULL;
+
+    for (int level = index->levels - 1; level >= 0; level--)
+    {
+        next = (lane == NULL) ? index->lanes[level] : lane->next;
+        while (next != NULL && ((cmp_func != NULL) ? cmp_func(next->node, key_node)
+                                                   : match_func(next->node, key)) < 0)
+        {
+            lane = next;
+            next = lane->next;
+        }
+        if (update != NULL)
+        {
+            update[level] = lane;
+        }
+        if (lane != NULL && level > 0)
+        {
+            lane = lane->down;
+        }
+    }
+
+    return (lane != NULL) ? lane->node : NULL;
+}
+
+/****************************************************************************
+ * Name: skip_insert
+ * Input:
+ *   SkipIndex_t *index  Index over the list.
+ *   ListNode_t **head   Head of the sorted list.
+ *   ListNode_t *new_node  Node to insert.
+ *   int32_t (*cmp_func)(ListNode_t *, ListNode_t *)  Same as insert_sorted().
+ * Return:
+ *   None
+ * Description:
+ *   insert_sorted() in O(log n): the lanes lead to the node just before the
+ *   insertion point, and the new node joins a random number of lanes.
+ ****************************************************************************/
+void skip_insert(SkipIndex_t *index, ListNode_t **head, ListNode_t *new_node,
+                 int32_t (*cmp_func)(ListNode_t *, ListNode_t *))
+{
+    SkipLane_t *update[SKIP_MAX_LEVEL] = {NULL};
+    SkipLane_t *lane = NULL;
+    SkipLane_t *below = NULL;
+    ListNode_t *last = NULL;
+    int height = 0;
+
+    if (index == NULL || head == NULL || new_node == NULL || cmp_func == NULL)
+    {
+        return;
+    }
+
+    last = skip_descend(index, new_node, 0, cmp_func, NULL, update);
+    if (last == NULL)
+    {
+        insert_sorted(head, new_node, cmp_func);
+    }
+    else
+    {
+        while (last->next != NULL && cmp_func(last->next, new_node) < 0)
+        {
+            last = last->next;
+        }
+        new_node->prev = last;
+        new_node->next = last->next;
+        if (last->next != NULL)
+        {
+            last->next->prev = new_node;
+        }
+        last->next = new_node;
+    }
+
+    height = skip_random_level(index);
+    for (int level = 0; level < height; level++)
+    {
+        lane = (SkipLane_t *)pool_alloc(&index->pool);
+        if (lane == NULL)
+        {
+            break;
+        }
+        lane->node = new_node;
+        lane->down = below;
+        if (level >= index->levels || update[level] == NULL)
+        {
+            lane->next = index->lanes[level];
+            index->lanes[level] = lane;
+        }
+        else
+        {
+            lane->next = update[level]->next;
+            update[level]->next = lane;
+        }
+        below = lane;
+        if (level >= index->levels)
+        {
+            index->levels = level + 1;
+        }
+    }
+
+    return;
+}
+
+/* search_sorted() in O(log n) */
+ListNode_t *skip_search(SkipIndex_t *index, ListNode_t *head, uint32_t search_item,
+                        int32_t (*match_func)(ListNode_t *, uint32_t))
+{
+    ListNode_t *start = NULL;
+
+    if (index == NULL || match_func == NULL)
+    {
+        return NULL;
+    }
+
+    start = skip_descend(index, NULL, search_item, NULL, match_func, NULL);
+
+    return search_sorted(search_item, match_func, (start != NULL) ? start : head);
+}
+
+/****************************************************************************
+ * Name: skip_delete
+ * Input:
+ *   SkipIndex_t *index  Index over the list.
+ *   ListNode_t **head   Head of the sorted list.
+ *   ListNode_t *node    Node to remove.
+ *   int32_t (*cmp_func)(ListNode_t *, ListNode_t *)  Order of the list.
+ *   void (*free_data)(ListNode_t *)  Same as delete_node().
+ * Return:
+ *   None
+ * Description:
+ *   delete_node() that also unlinks the node from every lane it is on,
+ *   found in O(log n) through the lanes. The node must be in the list.
+ ****************************************************************************/
+void skip_delete(SkipIndex_t *index, ListNode_t **head, ListNode_t *node,
+                 int32_t (*cmp_func)(ListNode_t *, ListNode_t *), void (*free_data)(ListNode_t *))
+{
+    SkipLane_t *update[SKIP_MAX_LEVEL] = {NULL};
+    SkipLane_t *lane = NULL;
+
+    if (index == NULL || node == NULL || cmp_func == NULL)
+    {
+        return;
+    }
+
+    skip_descend(index, node, 0, cmp_func, NULL, update);
+    for (int level = 0; level < index->levels; level++)
+    {
+        lane = (update[level] == NULL) ? index->lanes[level] : update[level]->next;
+        if (lane == NULL || lane->node != node)
+        {
+            break;
+        }
+        if (update[level] == NULL)
+        {
+            index->lanes[level] = lane->next;
+        }
+        else
+        {
+            update[level]->next = lane->next;
+        }
+        pool_free(&index->pool, lane);
+    }
+    while (index->levels > 0 && index->lanes[index->levels - 1] == NULL)
+    {
+        index->levels--;
+    }
+
+    delete_node(head, node, free_data);
+
+    return;
+}
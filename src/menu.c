@@ -7,6 +7,7 @@
 #include "grade.h"
 #include "heap.h"
 #include "menu.h"
+#include "report.h"
 #include "student.h"
 #include "terminal-control.h"
 
@@ -34,6 +35,11 @@ void init_menu()
     Main_Menu = add_menu("Save Data", &save_database, NULL, Main_Menu);
 
     sub_menu = add_menu("Return", NULL, NULL, NULL);
+    sub_menu = add_menu("Grade Distribution", &print_grade_distribution, NULL, sub_menu);
+    sub_menu = add_menu("Grade Statistics", &print_grade_statistics, NULL, sub_menu);
+    sub_menu = add_menu("Students Scoring at Least", &print_score_count, NULL, sub_menu);
+    sub_menu = add_menu("Rank and Percentile", &print_student_rank, NULL, sub_menu);
+    sub_menu = add_menu("Top / Bottom Students", &print_grade_ranking, NULL, sub_menu);
     sub_menu = add_menu("Display All Grades", &print_grades, NULL, sub_menu);
     sub_menu = add_menu("Update Grade", &update_grade_from_user, NULL, sub_menu);
     sub_menu = add_menu("Delete Grade", &delete_grade_from_user, NULL, sub_menu);
@@ -41,6 +47,7 @@ void init_menu()
     Main_Menu = add_menu("Grade Management", NULL, sub_menu, Main_Menu);
 
     sub_menu = add_menu("Return", NULL, NULL, NULL);
+    sub_menu = add_menu("Students in ID Range", &print_student_range, NULL, sub_menu);
     sub_menu = add_menu("Display All Students", &print_student, NULL, sub_menu);
     sub_menu = add_menu("Update Student", &update_student_from_user, NULL, sub_menu);
     sub_menu = add_menu("Delete Student", &delete_student_from_user, NULL, sub_menu);
@@ -0,0 +1,132 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "pool.h"
+
+struct PoolSlab
+{
+    PoolSlab_t *next;
+    _Alignas(POOL_ALIGN) char items[];
+};
+
+static bool_t pool_add_slab(Pool_t *pool, size_t item_count);
+
+static bool_t pool_add_slab(Pool_t *pool, size_t item_count)
+{
+    PoolSlab_t *slab = NULL;
+
+    slab = (PoolSlab_t *)malloc(sizeof(PoolSlab_t) + item_count * pool->item_size);
+    if (slab == NULL)
+    {
+        return false;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+
+    /* hand the tail of the previous slab to the free list before replacing it */
+    while (pool->unused_count > 0)
+    {
+        pool_free(pool, pool->unused);
+        pool->unused += pool->item_size;
+        pool->unused_count--;
+    }
+
+    pool->unused = slab->items;
+    pool->unused_count = item_count;
+
+    return true;
+}
+
+/****************************************************************************
+ * Name: pool_alloc
+ * Input:
+ *   Pool_t *pool  Pool to allocate from.
+ * Return:
+ *   void *        Pointer to a zero-initialized item of the pool's item size,
+ *                 or NULL if memory allocation failed.
+ * Description:
+ *   Takes an item from the free list if one is available, otherwise carves
+ *   the next item out of the current slab, allocating a new slab of
+ *   `slab_items` items when it is exhausted.
+ ****************************************************************************/
+void *pool_alloc(Pool_t *pool)
+{
+    void *item = NULL;
+
+    if (pool->free_list != NULL)
+    {
+        item = pool->free_list;
+        pool->free_list = *(void **)item;
+    }
+    else
+    {
+        if (pool->unused_count == 0 && pool_add_slab(pool, pool->slab_items) == false)
+        {
+            return NULL;
+        }
+        item = pool->unused;
+        pool->unused += pool->item_size;
+        pool->unused_count--;
+    }
+
+    memset(item, 0, pool->item_size);
+    return item;
+}
+
+void pool_free(Pool_t *pool, void *item)
+{
+    if (item == NULL)
+    {
+        return;
+    }
+    *(void **)item = pool->free_list;
+    pool->free_list = item;
+}
+
+/****************************************************************************
+ * Name: pool_reserve
+ * Input:
+ *   Pool_t *pool  Pool to grow.
+ *   size_t count  Number of items about to be allocated.
+ * Return:
+ *   bool_t        false if memory allocation failed, true otherwise.
+ * Description:
+ *   Makes sure the next `count` allocations come from one contiguous slab,
+ *   so bulk loads do a single allocation instead of one per slab.
+ ****************************************************************************/
+bool_t pool_reserve(Pool_t *pool, size_t count)
+{
+    if (count <= pool->unused_count)
+    {
+        return true;
+    }
+    return pool_add_slab(pool, count);
+}
+
+/****************************************************************************
+ * Name: pool_release
+ * Input:
+ *   Pool_t *pool  Pool to empty.
+ * Return:
+ *   None
+ * Description:
+ *   Frees every slab of the pool at once. All items allocated from the pool
+ *   become invalid; the pool can be used again afterwards.
+ ****************************************************************************/
+void pool_release(Pool_t *pool)
+{
+    PoolSlab_t *slab = pool->slabs;
+    PoolSlab_t *next = NULL;
+
+    while (slab != NULL)
+    {
+        next = slab->next;
+        free(slab);
+        slab = next;
+    }
+
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->unused = NULL;
+    pool->unused_count = 0;
+}
@@ -0,0 +1,714 @@
+#include <inttypes.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "column-stats.h"
+#include "common.h"
+#include "dept.h"
+#include "grade.h"
+#include "heap.h"
+#include "report.h"
+#include "student.h"
+#include "terminal-control.h"
+
+#define MAX_RANK_THREADS 8
+#define DISTRIBUTION_BUCKETS 10
+
+static char *Subject_Names[] = {"English", "Math", "History", "Total"};
+
+/* what print_grade_ranking() ranks by */
+typedef struct RankQuery
+{
+    int subject; /* index into Subject_Names, SUBJECT_TOTAL for the total */
+    bool_t bottom;
+    uint32_t k;
+} RankQuery_t;
+
+typedef struct DeptRanking
+{
+    Dept_t *dept;
+    BoundedHeap_t heap;
+} DeptRanking_t;
+
+/* a share of the departments, ranked on one thread */
+typedef struct RankWorker
+{
+    const RankQuery_t *query;
+    DeptRanking_t *rankings;
+    size_t count;
+    size_t first;
+    size_t stride;
+} RankWorker_t;
+
+static uint64_t rank_key(const RankQuery_t *query, uint32_t row);
+static void *rank_depts(void *arg);
+static void run_rank_workers(const RankQuery_t *query, DeptRanking_t *rankings, size_t count);
+static void print_ranking(const RankQuery_t *query, const char *scope, BoundedHeap_t *heap);
+static int select_subject(char *title);
+static void print_statistics_rows(const char *scope, const uint8_t *columns[], size_t count);
+static uint32_t max_score(int subject);
+static uint32_t count_between(int subject, uint32_t low, uint32_t high);
+static void print_histogram_line(const char *label, uint32_t count, uint32_t largest);
+static void print_bar_chart(int subject);
+static void print_full_histogram(int subject);
+static Student_t **order_by_score(int subject, size_t *count);
+
+/* SUBJECT_TOTAL or a subject index, -1 if the user backed out */
+static int select_subject(char *title)
+{
+    int32_t option = select_option((char *[]){title, Subject_Names[SUBJECT_TOTAL], Subject_Names[0],
+                                              Subject_Names[1], Subject_Names[2]},
+                                   SUBJECT_COUNT + 2, 1);
+    if (option < 0)
+    {
+        return -1;
+    }
+    /* the menu lists the total first */
+    return (option == 0) ? SUBJECT_TOTAL : option - 1;
+}
+
+/* larger keys rank first; ties go to the lower student ID */
+static uint64_t rank_key(const RankQuery_t *query, uint32_t row)
+{
+    uint32_t score = grade_score(row, query->subject);
+
+    if (query->bottom == true)
+    {
+        score = MAX_TOTAL - score;
+    }
+
+    return ((uint64_t)score << 32) | (UINT32_MAX - Grades.owner[row]->id);
+}
+
+static void *rank_depts(void *arg)
+{
+    RankWorker_t *worker = (RankWorker_t *)arg;
+    DeptRanking_t *ranking = NULL;
+
+    for (size_t i = worker->first; i < worker->count; i += worker->stride)
+    {
+        ranking = &worker->rankings[i];
+        for (Student_t *student = ranking->dept->students; student != NULL;
+             student = (Student_t *)student->node.next)
+        {
+            if (student->grade_row != GRADE_NONE)
+            {
+                bounded_heap_offer(&ranking->heap, rank_key(worker->query, student->grade_row),
+                                   student);
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/****************************************************************************
+ * Name: run_rank_workers
+ * Input:
+ *   const RankQuery_t *query  What to rank by.
+ *   DeptRanking_t *rankings   One entry per department, heaps initialised.
+ *   size_t count              Number of departments.
+ * Return:
+ *   None
+ * Description:
+ *   Fills every department's heap. The departments are spread over up to
+ *   one thread per CPU; the threads only read the students and grades and
+ *   each writes its own heaps. A thread that cannot be started has its
+ *   share ranked on the calling thread.
+ ****************************************************************************/
+static void run_rank_workers(const RankQuery_t *query, DeptRanking_t *rankings, size_t count)
+{
+    RankWorker_t workers[MAX_RANK_THREADS];
+    size_t worker_count = 1;
+
+#ifdef USE_PARALLEL_REPORTS
+    pthread_t threads[MAX_RANK_THREADS];
+    bool_t started[MAX_RANK_THREADS] = {false};
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    worker_count = (cpus > 1) ? (size_t)cpus : 1;
+    worker_count = (worker_count > MAX_RANK_THREADS) ? MAX_RANK_THREADS : worker_count;
+    worker_count = (worker_count > count) ? count : worker_count;
+#endif
+
+    for (size_t i = 0; i < worker_count; i++)
+    {
+        workers[i].query = query;
+        workers[i].rankings = rankings;
+        workers[i].count = count;
+        workers[i].first = i;
+        workers[i].stride = worker_count;
+    }
+
+#ifdef USE_PARALLEL_REPORTS
+    for (size_t i = 1; i < worker_count; i++)
+    {
+        started[i] = (pthread_create(&threads[i], NULL, &rank_depts, &workers[i]) == 0);
+    }
+    rank_depts(&workers[0]);
+    for (size_t i = 1; i < worker_count; i++)
+    {
+        if (started[i] == true)
+        {
+            pthread_join(threads[i], NULL);
+        }
+        else
+        {
+            rank_depts(&workers[i]);
+        }
+    }
+#else
+    rank_depts(&workers[0]);
+#endif
+
+    return;
+}
+
+static void print_ranking(const RankQuery_t *query, const char *scope, BoundedHeap_t *heap)
+{
+    size_t count = bounded_heap_sort(heap);
+    Student_t *student = NULL;
+    uint32_t row = 0;
+
+    printf("\n%s %" PRIu32 " by %s, %s\n", (query->bottom == true) ? "Bottom" : "Top", query->k,
+           Subject_Names[query->subject], scope);
+#ifdef USE_UNICODE
+    printf("┌──────┬──────────┬──────────────────────┬─────────┬─────────┬─────────┬───────┐\n");
+    printf("│ Rank │    ID    │    Student Name      │ English │   Math  │ History │ Total │\n");
+    printf("├──────┼──────────┼──────────────────────┼─────────┼─────────┼─────────┼───────┤\n");
+#else
+    printf("+------+----------+----------------------+---------+---------+---------+-------+\n");
+    printf("| Rank |    ID    |    Student Name      | English |   Math  | History | Total |\n");
+    printf("+------+----------+----------------------+---------+---------+---------+-------+\n");
+#endif
+    for (size_t i = 0; i < count; i++)
+    {
+        student = (Student_t *)heap->entries[i].item;
+        row = student->grade_row;
+        printf(PIPE2 " %4zu " PIPE2 " BDCOM%03" PRIu32 " " PIPE2 " %20s " PIPE2 " %7" PRIu8
+                     " " PIPE2 " %7" PRIu8 " " PIPE2 " %7" PRIu8 " " PIPE2 " %5" PRIu32 " " PIPE2
+                     "\n",
+               i + 1, student->id, student_name(student), Grades.english[row], Grades.math[row],
+               Grades.history[row], grade_score(row, SUBJECT_TOTAL));
+    }
+#ifdef USE_UNICODE
+    printf("└──────┴──────────┴──────────────────────┴─────────┴─────────┴─────────┴───────┘\n");
+#else
+    printf("+------+----------+----------------------+---------+---------+---------+-------+\n");
+#endif
+
+    return;
+}
+
+/****************************************************************************
+ * Name: print_grade_ranking
+ * Input: None
+ * Return: None
+ * Description:
+ *   Asks for top or bottom, the subject or total to rank by, K and the
+ *   scope, then prints the K best or worst graded students overall or in
+ *   every department. Each ranking is a single pass that keeps the K best
+ *   seen in a bounded heap, O(N log K) without sorting all students; the
+ *   per-department rankings run in parallel.
+ ****************************************************************************/
+void print_grade_ranking()
+{
+    RankQuery_t query = {0};
+    BoundedHeap_t heap = {0};
+    DeptRanking_t *rankings = NULL;
+    size_t dept_count = 0;
+    int32_t option = 0;
+    bool_t per_dept = false;
+    char scope[DEPT_NAME_SIZE + 16];
+
+    option = select_option((char *[]){"Rank Students", "Top", "Bottom"}, 3, 1);
+    if (option < 0)
+    {
+        return;
+    }
+    query.bottom = (option == 1);
+
+    query.subject = select_subject("Rank By");
+    if (query.subject < 0)
+    {
+        return;
+    }
+
+    option = select_option((char *[]){"Scope", "All Students", "Each Department"}, 3, 1);
+    if (option < 0)
+    {
+        return;
+    }
+    per_dept = (option == 1);
+
+    query.k = get_int("Number of Students", INT_DEPT_LENGTH, NULL);
+    if (query.k == UINT32_MAX || query.k == 0)
+    {
+        popup("Message", "Number of students not provided.", "OK");
+        return;
+    }
+
+    if (per_dept == false)
+    {
+        if (bounded_heap_init(&heap, (query.k < Grades.count) ? query.k : Grades.count) == false)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            press_any_key();
+            return;
+        }
+        for (uint32_t row = 0; row < Grades.count; row++)
+        {
+            bounded_heap_offer(&heap, rank_key(&query, row), Grades.owner[row]);
+        }
+        system("clear");
+        print_ranking(&query, "all students", &heap);
+        bounded_heap_free(&heap);
+        press_any_key();
+        return;
+    }
+
+    for (Dept_t *dept = Dept_Head; dept != NULL; dept = (Dept_t *)dept->node.next)
+    {
+        dept_count++;
+    }
+    rankings = (DeptRanking_t *)calloc((dept_count > 0) ? dept_count : 1, sizeof(DeptRanking_t));
+    if (rankings == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        press_any_key();
+        return;
+    }
+
+    dept_count = 0;
+    for (Dept_t *dept = Dept_Head; dept != NULL; dept = (Dept_t *)dept->node.next)
+    {
+        rankings[dept_count].dept = dept;
+        if (bounded_heap_init(&rankings[dept_count].heap, (query.k < dept->stats.graded)
+                                                              ? query.k
+                                                              : dept->stats.graded) == false)
+        {
+            fprintf(stderr, "Memory allocation failed\n");
+            press_any_key();
+            break;
+        }
+        dept_count++;
+    }
+
+    run_rank_workers(&query, rankings, dept_count);
+
+    system("clear");
+    for (size_t i = 0; i < dept_count; i++)
+    {
+        snprintf(scope, sizeof(scope), "%s (%" PRIu32 ")", rankings[i].dept->name,
+                 rankings[i].dept->id);
+        print_ranking(&query, scope, &rankings[i].heap);
+        bounded_heap_free(&rankings[i].heap);
+    }
+    free(rankings);
+    press_any_key();
+
+    return;
+}
+
+/****************************************************************************
+ * Name: print_student_rank
+ * Input: None
+ * Return: None
+ * Description:
+ *   Asks for a student and prints its rank and percentile by total and by
+ *   every subject among all graded students. Students with the same score
+ *   share a rank; the percentile is the share of students scoring at most
+ *   as much. Each figure is a pair of O(log MAX_TOTAL) count lookups.
+ ****************************************************************************/
+void print_student_rank()
+{
+    uint32_t id = 0;
+    Student_t *student = NULL;
+    int subject = 0;
+    uint32_t score = 0;
+    uint32_t graded = 0;
+
+    id = get_int("Student ID", INT_STUDENT_LENGTH + 1, NULL);
+    if (id == UINT32_MAX)
+    {
+        popup("Message", "Student ID not provided.", "OK");
+        return;
+    }
+
+    student = search_student(id);
+    if (student == NULL)
+    {
+        popup("Error", "No Student found with this ID.", "OK");
+        return;
+    }
+    if (student->grade_row == GRADE_NONE)
+    {
+        popup("Error", "This student has no grades.", "OK");
+        return;
+    }
+
+    system("clear");
+    printf("BDCOM%03" PRIu32 ": %s\n", student->id, student_name(student));
+#ifdef USE_UNICODE
+    printf("┌─────────┬───────┬────────────────────┬────────────┐\n");
+    printf("│ Subject │ Score │        Rank        │ Percentile │\n");
+    printf("├─────────┼───────┼────────────────────┼────────────┤\n");
+#else
+    printf("+---------+-------+--------------------+------------+\n");
+    printf("| Subject | Score |        Rank        | Percentile |\n");
+    printf("+---------+-------+--------------------+------------+\n");
+#endif
+    for (int i = 0; i <= SUBJECT_COUNT; i++)
+    {
+        subject = (i == 0) ? SUBJECT_TOTAL : i - 1;
+        score = grade_score(student->grade_row, subject);
+        graded = grades_at_least(subject, 0);
+        printf(PIPE2 " %-7s " PIPE2 " %5" PRIu32 " " PIPE2 " %7" PRIu32 " of %7" PRIu32 " " PIPE2
+                     " %9.1f%% " PIPE2 "\n",
+               Subject_Names[subject], score, grades_at_least(subject, score + 1) + 1, graded,
+               100.0 * grades_at_most(subject, score) / graded);
+    }
+#ifdef USE_UNICODE
+    printf("└─────────┴───────┴────────────────────┴────────────┘\n");
+#else
+    printf("+---------+-------+--------------------+------------+\n");
+#endif
+    press_any_key();
+
+    return;
+}
+
+/* how many graded students reach a minimum score, by total or subject */
+void print_score_count()
+{
+    int subject = 0;
+    uint32_t score = 0;
+    char message[96];
+
+    subject = select_subject("Count Students By");
+    if (subject < 0)
+    {
+        return;
+    }
+
+    score = get_int("Minimum Score", INT_GRADE_LENGTH + 1, NULL);
+    if (score == UINT32_MAX)
+    {
+        popup("Message", "Minimum score not provided.", "OK");
+        return;
+    }
+
+    snprintf(message, sizeof(message), "%" PRIu32 " of %" PRIu32 " students scored %" PRIu32
+             " or more in %s.", grades_at_least(subject, score), grades_at_least(subject, 0),
+             score, Subject_Names[subject]);
+    popup("Result", message, "OK");
+
+    return;
+}
+
+/* one row per subject, statistics of `count` marks in each of the columns */
+static void print_statistics_rows(const char *scope, const uint8_t *columns[], size_t count)
+{
+    ColumnStats_t stats;
+    double mean = 0.0;
+    double variance = 0.0;
+
+    for (int i = 0; i < SUBJECT_COUNT; i++)
+    {
+        printf(PIPE2 " %20.20s " PIPE2 " %-7s ", (i == 0) ? scope : "", Subject_Names[i]);
+        if (count == 0)
+        {
+            printf(PIPE2 "       0 " PIPE2 "      - " PIPE2 "   - " PIPE2 "   - " PIPE2 "       - "
+                   PIPE2 "               - " PIPE2 "\n");
+            continue;
+        }
+
+        column_stats(columns[i], count, PASS_MARK, &stats);
+        mean = (double)stats.sum / stats.count;
+        variance = (double)stats.sum_squares / stats.count - mean * mean;
+        printf(PIPE2 " %7" PRIu64 " " PIPE2 " %6.1f " PIPE2 " %3" PRIu8 " " PIPE2 " %3" PRIu8
+                     " " PIPE2 " %7.1f " PIPE2 " %6" PRIu64 " (%5.1f%%) " PIPE2 "\n",
+               stats.count, mean, stats.min, stats.max, (variance > 0.0) ? sqrt(variance) : 0.0,
+               stats.passed, 100.0 * stats.passed / stats.count);
+    }
+}
+
+/****************************************************************************
+ * Name: print_grade_statistics
+ * Input: None
+ * Return: None
+ * Description:
+ *   Mean, min, max, standard deviation and pass count of every subject,
+ *   over all graded students and per department. The overall figures run
+ *   the column_stats() SIMD kernels straight over the Grades columns; for
+ *   the departments, each department's marks are first gathered into
+ *   contiguous scratch columns.
+ ****************************************************************************/
+void print_grade_statistics()
+{
+    const uint8_t *columns[SUBJECT_COUNT] = {Grades.english, Grades.math, Grades.history};
+    uint8_t *scratch = NULL;
+    size_t count = 0;
+    uint32_t row = 0;
+
+    scratch = (uint8_t *)malloc(((Grades.count > 0) ? Grades.count : 1) * SUBJECT_COUNT);
+    if (scratch == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        press_any_key();
+        return;
+    }
+
+    system("clear");
+    printf("Pass mark %d, %s kernel\n", PASS_MARK, column_stats_kernel());
+#ifdef USE_UNICODE
+    printf("┌──────────────────────┬─────────┬─────────┬────────┬─────┬─────┬─────────┬────────────"
+           "─────┐\n");
+    printf("│       Department     │ Subject │  Graded │   Mean │ Min │ Max │ Std Dev │      Passed"
+           "     │\n");
+    printf("├──────────────────────┼─────────┼─────────┼────────┼─────┼─────┼─────────┼────────────"
+           "─────┤\n");
+#else
+    printf("+----------------------+---------+---------+--------+-----+-----+---------+------------"
+           "-----+\n");
+    printf("|       Department     | Subject |  Graded |   Mean | Min | Max | Std Dev |      Passed"
+           "     |\n");
+    printf("+----------------------+---------+---------+--------+-----+-----+---------+------------"
+           "-----+\n");
+#endif
+    print_statistics_rows("All", columns, Grades.count);
+
+    for (Dept_t *dept = Dept_Head; dept != NULL; dept = (Dept_t *)dept->node.next)
+    {
+        columns[0] = scratch;
+        columns[1] = scratch + Grades.count;
+        columns[2] = scratch + 2 * (size_t)Grades.count;
+        count = 0;
+        for (Student_t *student = dept->students; student != NULL;
+             student = (Student_t *)student->node.next)
+        {
+            row = student->grade_row;
+            if (row != GRADE_NONE)
+            {
+                scratch[count] = Grades.english[row];
+                scratch[Grades.count + count] = Grades.math[row];
+                scratch[2 * (size_t)Grades.count + count] = Grades.history[row];
+                count++;
+            }
+        }
+        print_statistics_rows(dept->name, columns, count);
+    }
+#ifdef USE_UNICODE
+    printf("└──────────────────────┴─────────┴─────────┴────────┴─────┴─────┴─────────┴────────────"
+           "─────┘\n");
+#else
+    printf("+----------------------+---------+---------+--------+-----+-----+---------+------------"
+           "-----+\n");
+#endif
+    free(scratch);
+    press_any_key();
+
+    return;
+}
+
+static uint32_t max_score(int subject)
+{
+    return (subject == SUBJECT_TOTAL) ? MAX_TOTAL : MAX_GRADE;
+}
+
+/* graded students scoring from `low` to `high` inclusive, from the score counts */
+static uint32_t count_between(int subject, uint32_t low, uint32_t high)
+{
+    return grades_at_most(subject, high) - ((low > 0) ? grades_at_most(subject, low - 1) : 0);
+}
+
+/* `label`, the count and a bar scaled so that `largest` fills the terminal */
+static void print_histogram_line(const char *label, uint32_t count, uint32_t largest)
+{
+    size_t width = terminal_width();
+    size_t filled = 0;
+
+    /* label, count and the spaces around them */
+    width = (width > 40) ? width - 20 : 20;
+    if (largest > 0)
+    {
+        /* round up so that any non-zero count shows */
+        filled = ((size_t)count * width + largest - 1) / largest;
+    }
+    printf("%9s %7" PRIu32 " ", label, count);
+    print_bar(filled, width);
+    putchar('\n');
+}
+
+/* DISTRIBUTION_BUCKETS equal ranges of scores, the last one also holding the maximum */
+static void print_bar_chart(int subject)
+{
+    uint32_t step = max_score(subject) / DISTRIBUTION_BUCKETS;
+    uint32_t counts[DISTRIBUTION_BUCKETS] = {0};
+    uint32_t largest = 0;
+    uint32_t high = 0;
+    char label[16];
+
+    for (uint32_t i = 0; i < DISTRIBUTION_BUCKETS; i++)
+    {
+        high = (i + 1 == DISTRIBUTION_BUCKETS) ? max_score(subject) : (i + 1) * step - 1;
+        counts[i] = count_between(subject, i * step, high);
+        largest = (counts[i] > largest) ? counts[i] : largest;
+    }
+
+    printf("\n%s\n", Subject_Names[subject]);
+    for (uint32_t i = 0; i < DISTRIBUTION_BUCKETS; i++)
+    {
+        high = (i + 1 == DISTRIBUTION_BUCKETS) ? max_score(subject) : (i + 1) * step - 1;
+        snprintf(label, sizeof(label), "%3" PRIu32 "-%3" PRIu32, i * step, high);
+        print_histogram_line(label, counts[i], largest);
+    }
+}
+
+/* one line for every possible score */
+static void print_full_histogram(int subject)
+{
+    uint32_t largest = 0;
+    uint32_t count = 0;
+    char label[16];
+
+    for (uint32_t score = 0; score <= max_score(subject); score++)
+    {
+        count = count_between(subject, score, score);
+        largest = (count > largest) ? count : largest;
+    }
+
+    printf("%s\n", Subject_Names[subject]);
+    for (uint32_t score = 0; score <= max_score(subject); score++)
+    {
+        snprintf(label, sizeof(label), "%3" PRIu32, score);
+        print_histogram_line(label, count_between(subject, score, score), largest);
+    }
+}
+
+/****************************************************************************
+ * Name: order_by_score
+ * Input:
+ *   int subject    Subject, or SUBJECT_TOTAL, to order by.
+ *   size_t *count  Receives the number of students in the array.
+ * Return:
+ *   Student_t **   Graded students from the highest score down, students
+ *                  with the same score in ID order; NULL on failure. The
+ *                  caller frees it.
+ * Description:
+ *   Counting sort keyed on the score, O(N + max_score(subject)). The input
+ *   is the ID-ordered student view, and counting sort is stable, which
+ *   breaks ties by ID without comparing.
+ ****************************************************************************/
+static Student_t **order_by_score(int subject, size_t *count)
+{
+    uint32_t starts[MAX_TOTAL + 2] = {0};
+    uint32_t highest = max_score(subject);
+    Student_t **students = NULL;
+    Student_t **ordered = NULL;
+    size_t student_count = 0;
+    uint32_t key = 0;
+
+    if (sorted_students(&students, &student_count) == false)
+    {
+        return NULL;
+    }
+    ordered = (Student_t **)malloc(((Grades.count > 0) ? Grades.count : 1) * sizeof(Student_t *));
+    if (ordered == NULL)
+    {
+        return NULL;
+    }
+
+    /* the key counts down from the highest score, so the order is descending */
+    for (size_t i = 0; i < student_count; i++)
+    {
+        if (students[i]->grade_row != GRADE_NONE)
+        {
+            key = grade_score(students[i]->grade_row, subject);
+            starts[highest - ((key < highest) ? key : highest) + 1]++;
+        }
+    }
+    for (uint32_t i = 1; i <= highest + 1; i++)
+    {
+        starts[i] += starts[i - 1];
+    }
+    for (size_t i = 0; i < student_count; i++)
+    {
+        if (students[i]->grade_row != GRADE_NONE)
+        {
+            key = grade_score(students[i]->grade_row, subject);
+            ordered[starts[highest - ((key < highest) ? key : highest)]++] = students[i];
+        }
+    }
+    *count = Grades.count;
+
+    return ordered;
+}
+
+/****************************************************************************
+ * Name: print_grade_distribution
+ * Input: None
+ * Return: None
+ * Description:
+ *   Bucketed bar charts of every subject and the total, a histogram of
+ *   every score of one subject, or the grade table ordered by one subject.
+ *   The charts read the score counts kept for rank queries and touch no
+ *   student; the ordering is a counting sort.
+ ****************************************************************************/
+void print_grade_distribution()
+{
+    int32_t option = 0;
+    int subject = 0;
+    Student_t **ordered = NULL;
+    size_t count = 0;
+
+    option = select_option((char *[]){"Grade Distribution", "Bar Charts", "Full Histogram",
+                                      "Order Students by Score"},
+                           4, 1);
+    if (option < 0)
+    {
+        return;
+    }
+
+    if (option == 0)
+    {
+        system("clear");
+        for (int i = 0; i <= SUBJECT_COUNT; i++)
+        {
+            print_bar_chart(i);
+        }
+        press_any_key();
+        return;
+    }
+
+    subject = select_subject((option == 1) ? "Histogram Of" : "Order By");
+    if (subject < 0)
+    {
+        return;
+    }
+
+    if (option == 1)
+    {
+        system("clear");
+        print_full_histogram(subject);
+        press_any_key();
+        return;
+    }
+
+    ordered = order_by_score(subject, &count);
+    if (ordered == NULL)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        press_any_key();
+        return;
+    }
+    system("clear");
+    print_grade_table(ordered, count);
+    free(ordered);
+    press_any_key();
+
+    return;
+}
@@ -4,21 +4,96 @@
 #include <string.h>
 
 #include "common.h"
+#include "data-file.h"
 #include "dept.h"
 #include "grade.h"
+#include "hash-index.h"
 #include "heap.h"
+#include "journal.h"
+#include "pool.h"
 #include "student.h"
 #include "terminal-control.h"
+#include "typed-list.h"
+
+DEFINE_TYPED_MERGE(student, Student_t, id)
 
 Student_t *Student_Head = NULL;
+uint32_t Student_Generation = 0;
+static HashIndex_t Student_Index = {0};
+static ParsedTable_t Parsed_Students = {0};
+/* used by parse_students() on a loader thread, and only by the main thread after it */
+static Pool_t Student_Pool = POOL_INITIALIZER(Student_t, 1024);
+static SkipIndex_t Student_Head_Lanes = SKIP_INDEX_INITIALIZER;
+
+/* names by Student_t::slot, freed rows are chained through Free_Name_Slot */
+static char (*Student_Names)[STUDENT_NAME_SIZE] = NULL;
+static uint32_t Name_Slot_Count = 0;
+static uint32_t Name_Slot_Capacity = 0;
+static uint32_t Free_Name_Slot = UINT32_MAX;
+
+/* compact records: one-byte ID delta, department and name length, empty name */
+#define STUDENT_MIN_RECORD_SIZE 3
 
 static Student_t *create_student(uint32_t id, const char *name, char gender, Dept_t *dept);
-static int32_t match_student(ListNode_t *node, uint32_t id);
 static void free_student(ListNode_t *node);
+static ListNode_t **student_list(Dept_t *dept);
+static SkipIndex_t *student_lanes(Dept_t *dept);
+static bool_t reserve_name_slots(uint32_t capacity);
+static uint32_t alloc_name_slot();
+static void free_name_slot(uint32_t slot);
+
+static bool_t reserve_name_slots(uint32_t capacity)
+{
+    char(*names)[STUDENT_NAME_SIZE] = NULL;
+
+    if (capacity <= Name_Slot_Capacity)
+    {
+        return true;
+    }
+    names = realloc(Student_Names, (size_t)capacity * STUDENT_NAME_SIZE);
+    if (names == NULL)
+    {
+        return false;
+    }
+    Student_Names = names;
+    Name_Slot_Capacity = capacity;
+
+    return true;
+}
+
+/* returns UINT32_MAX if the side table could not grow */
+static uint32_t alloc_name_slot()
+{
+    uint32_t slot = Free_Name_Slot;
+
+    if (slot != UINT32_MAX)
+    {
+        memcpy(&Free_Name_Slot, Student_Names[slot], sizeof(uint32_t));
+        return slot;
+    }
+    if (Name_Slot_Count == Name_Slot_Capacity &&
+        reserve_name_slots((Name_Slot_Capacity == 0) ? 1024 : Name_Slot_Capacity * 2) == false)
+    {
+        return UINT32_MAX;
+    }
+
+    return Name_Slot_Count++;
+}
+
+static void free_name_slot(uint32_t slot)
+{
+    memcpy(Student_Names[slot], &Free_Name_Slot, sizeof(uint32_t));
+    Free_Name_Slot = slot;
+}
+
+char *student_name(const Student_t *student)
+{
+    return Student_Names[student->slot];
+}
 
 static Student_t *create_student(uint32_t id, const char *name, char gender, Dept_t *dept)
 {
-    Student_t *new_student = (Student_t *)calloc(1, sizeof(Student_t));
+    Student_t *new_student = (Student_t *)pool_alloc(&Student_Pool);
     if (new_student == NULL)
     {
         fprintf(stderr, "Memory allocation failed\n");
@@ -26,28 +101,31 @@ static Student_t *create_student(uint32_t id, const char *name, char gender, Dep
         return NULL;
     }
 
-    new_student->id = id;
-    new_student->gender = gender;
-    new_student->dept = dept;
-    new_student->name = string_alloc(name, STUDENT_NAME_SIZE);
-    if (new_student->name == NULL)
+    new_student->slot = alloc_name_slot();
+    if (new_student->slot == UINT32_MAX)
     {
         fprintf(stderr, "Memory allocation failed\n");
-        free(new_student);
+        pool_free(&Student_Pool, new_student);
         press_any_key();
         return NULL;
     }
 
-    return new_student;
-}
+    new_student->id = id;
+    new_student->gender = gender;
+    new_student->grade_row = GRADE_NONE;
+    new_student->dept_id = (dept != NULL) ? dept->id : DEPT_NONE;
+    string_copy(Student_Names[new_student->slot], name, STUDENT_NAME_SIZE);
 
-static int32_t match_student(ListNode_t *node, uint32_t id)
-{
-    if (node == NULL)
+    if (hash_index_insert(&Student_Index, id, new_student) == false)
     {
-        return 1;
+        fprintf(stderr, "Memory allocation failed\nNot enough memory to index new student.\n");
+        free_name_slot(new_student->slot);
+        pool_free(&Student_Pool, new_student);
+        press_any_key();
+        return NULL;
     }
-    return compare_uint32(((Student_t *)node)->id, id);
+
+    return new_student;
 }
 
 int32_t cmp_student(ListNode_t *node1, ListNode_t *node2)
@@ -66,48 +144,159 @@ int32_t cmp_student(ListNode_t *node1, ListNode_t *node2)
 static void free_student(ListNode_t *node)
 {
     Student_t *student = (Student_t *)node;
-    if (student->name != NULL)
+    hash_index_remove(&Student_Index, student->id);
+    delete_grade(student);
+    free_name_slot(student->slot);
+    pool_free(&Student_Pool, student);
+}
+
+/* releases every student at once, including those still in department lists */
+void cleanup_student()
+{
+    Dept_t *dept = Dept_Head;
+
+    Student_Head = NULL;
+    skip_index_free(&Student_Head_Lanes);
+    while (dept != NULL)
+    {
+        dept->students = NULL;
+        skip_index_free(&dept->student_lanes);
+        dept = (Dept_t *)dept->node.next;
+    }
+    hash_index_free(&Student_Index);
+    sorted_view_free();
+    pool_release(&Student_Pool);
+    free(Student_Names);
+    Student_Names = NULL;
+    Name_Slot_Count = 0;
+    Name_Slot_Capacity = 0;
+    Free_Name_Slot = UINT32_MAX;
+}
+
+Student_t *search_student(uint32_t id)
+{
+    return (Student_t *)hash_index_find(&Student_Index, id);
+}
+
+/* students without a department are kept in Student_Head */
+static ListNode_t **student_list(Dept_t *dept)
+{
+    if (dept == NULL)
     {
-        free(student->name);
+        return (ListNode_t **)&Student_Head;
     }
-    if (student->grade != NULL)
+    return (ListNode_t **)&dept->students;
+}
+
+static SkipIndex_t *student_lanes(Dept_t *dept)
+{
+    if (dept == NULL)
     {
-        free(student->grade); // todo: fix
+        return &Student_Head_Lanes;
     }
-    free(student);
+    return &dept->student_lanes;
 }
 
-void cleanup_student()
+/****************************************************************************
+ * Name: orphan_students
+ * Input:
+ *   Dept_t *dept  Department about to be freed.
+ * Return:
+ *   None
+ * Description:
+ *   Moves the students of `dept` to Student_Head, leaving them without a
+ *   department, and drops the department's lanes.
+ ****************************************************************************/
+void orphan_students(Dept_t *dept)
 {
-    while (Student_Head != NULL)
+    Student_t *student = dept->students;
+
+    if (student == NULL)
     {
-        delete_node((ListNode_t **)&Student_Head, (ListNode_t *)Student_Head, free_student);
+        skip_index_free(&dept->student_lanes);
+        return;
+    }
+
+    while (student != NULL)
+    {
+        student->dept_id = DEPT_NONE;
+        student = (Student_t *)student->node.next;
     }
+    student_merge_sorted(&Student_Head, dept->students);
+    dept->students = NULL;
+    skip_index_free(&dept->student_lanes);
+    skip_index_build(&Student_Head_Lanes, (ListNode_t *)Student_Head);
+    Student_Generation++;
 }
 
-Student_t *search_student(uint32_t id)
+/****************************************************************************
+ * Name: student_put
+ * Input:
+ *   uint32_t id       ID of the student.
+ *   const char *name  Name of the student.
+ *   char gender       'm' or 'f'.
+ *   Dept_t *dept      Department of the student, NULL for none.
+ * Return:
+ *   Student_t *       The created or updated student, NULL on failure.
+ * Description:
+ *   Creates the student, or updates the name, gender and department of an
+ *   existing one, moving it between department lists when needed. This is
+ *   the non-interactive part of adding and editing a student, shared with
+ *   journal replay.
+ ****************************************************************************/
+Student_t *student_put(uint32_t id, const char *name, char gender, Dept_t *dept)
 {
-    int32_t result = -1;
-    Student_t *stud = NULL;
+    Student_t *student = NULL;
+    Dept_t *old_dept = NULL;
 
-    sorted_student_init();
-    stud = sorted_student_next();
-    while (stud != NULL)
+    student = search_student(id);
+    if (student == NULL)
     {
-        result = match_student((ListNode_t *)stud, id);
-        if (result >= 0)
+        student = create_student(id, name, gender, dept);
+        if (student != NULL)
         {
-            break;
+            skip_insert(student_lanes(dept), student_list(dept), (ListNode_t *)student,
+                        &cmp_student);
+            dept_stats_apply(dept, student, 1);
+            sorted_view_insert(student);
+            Student_Generation++;
         }
-        stud = sorted_student_next();
+        return student;
+    }
+
+    old_dept = search_dept(student->dept_id);
+    dept_stats_apply(old_dept, student, -1);
+    string_copy(Student_Names[student->slot], name, STUDENT_NAME_SIZE);
+    student->gender = gender;
+
+    if (old_dept != dept)
+    {
+        skip_delete(student_lanes(old_dept), student_list(old_dept), (ListNode_t *)student,
+                    &cmp_student, NULL);
+        skip_insert(student_lanes(dept), student_list(dept), (ListNode_t *)student, &cmp_student);
+        student->dept_id = (dept != NULL) ? dept->id : DEPT_NONE;
     }
-    sorted_student_free();
+    dept_stats_apply(dept, student, 1);
+    Student_Generation++;
+
+    return student;
+}
+
+void student_remove(uint32_t id)
+{
+    Student_t *student = search_student(id);
+    Dept_t *dept = NULL;
 
-    if (result == 0)
+    if (student != NULL)
     {
-        return stud;
+        dept = search_dept(student->dept_id);
+        sorted_view_remove(student);
+        delete_grade(student);
+        dept_stats_apply(dept, student, -1);
+        skip_delete(student_lanes(dept), student_list(dept), (ListNode_t *)student, &cmp_student,
+                    &free_student);
+        Student_Generation++;
     }
-    return NULL;
 }
 
 void student_from_user()
@@ -148,22 +337,22 @@ void student_from_user()
     dept_id = get_int("Department ID", INT_DEPT_LENGTH, NULL);
     if (dept_id != UINT32_MAX)
     {
-        dept = (Dept_t *)search_sorted(dept_id, &match_dept, (ListNode_t *)Dept_Head);
+        dept = search_dept(dept_id);
+    }
+
+    stud = student_put(id, name, gender, dept);
+    free(name);
+    if (stud == NULL)
+    {
+        return;
     }
+    journal_student_put(stud);
 
     if (dept == NULL)
     {
-        insert_sorted((ListNode_t **)&Student_Head,
-                      (ListNode_t *)create_student(id, name, gender, NULL), &cmp_student);
         popup("No department with given department id", "Student created with no department.",
               "OK");
     }
-    else
-    {
-        insert_sorted((ListNode_t **)&dept->students,
-                      (ListNode_t *)create_student(id, name, gender, dept), &cmp_student);
-    }
-    free(name);
 
     return;
 }
@@ -187,14 +376,8 @@ void delete_student_from_user()
         return;
     }
 
-    if (student->dept == NULL)
-    {
-        delete_node((ListNode_t **)&Student_Head, (ListNode_t *)student, &free_student);
-    }
-    else
-    {
-        delete_node((ListNode_t **)&student->dept->students, (ListNode_t *)student, &free_student);
-    }
+    student_remove(id);
+    journal_student_delete(id);
 
     return;
 }
@@ -207,8 +390,6 @@ void update_student_from_user()
     char new_gender = '\0';
     Dept_t *new_dept = NULL;
     uint32_t new_dept_id = 0;
-    ListNode_t **new_head = NULL;
-    ListNode_t **old_head = NULL;
     char *buffer = NULL;
     uint32_t buffer_length = 0;
 
@@ -239,7 +420,8 @@ void update_student_from_user()
         return;
     }
 
-    new_name = get_str("Enter Updated student name", DEPT_NAME_SIZE, &isprint, student->name);
+    new_name =
+        get_str("Enter Updated student name", DEPT_NAME_SIZE, &isprint, student_name(student));
     if (new_name == NULL || new_name[0] == '\0')
     {
         free(buffer);
@@ -252,9 +434,9 @@ void update_student_from_user()
                      ? 'm'
                      : 'f';
 
-    if (student->dept != NULL)
+    if (student->dept_id != DEPT_NONE)
     {
-        snprintf(buffer, buffer_length, "%" PRIu32, student->dept->id);
+        snprintf(buffer, buffer_length, "%" PRIu32, student->dept_id);
     }
     else
     {
@@ -263,72 +445,57 @@ void update_student_from_user()
     new_dept_id = get_int("Department ID", INT_DEPT_LENGTH, buffer);
     if (new_dept_id != UINT32_MAX)
     {
-        new_dept = (Dept_t *)search_sorted(new_dept_id, &match_dept, (ListNode_t *)Dept_Head);
-    }
-
-    if (student->dept == NULL)
-    {
-        old_head = (ListNode_t **)&Student_Head;
-    }
-    else
-    {
-        old_head = (ListNode_t **)&student->dept->students;
+        new_dept = search_dept(new_dept_id);
     }
 
     if (new_dept == NULL)
     {
-        new_head = (ListNode_t **)&Student_Head;
         popup("No department with this id", "Departent changed to None.", "OK");
     }
-    else
-    {
-        new_head = (ListNode_t **)&new_dept->students;
-    }
 
     /* update the student with new info */
     free(buffer);
-    free(student->name);
-    student->name = new_name;
-    student->gender = new_gender;
-    delete_node(old_head, (ListNode_t *)student, NULL);
-    insert_sorted(new_head, (ListNode_t *)student, &cmp_student);
-    student->dept = new_dept;
+    student = student_put(student_id, new_name, new_gender, new_dept);
+    free(new_name);
+    if (student != NULL)
+    {
+        journal_student_put(student);
+    }
 
     return;
 }
 
 static void print_student_row(Student_t *student)
 {
+    Dept_t *dept = search_dept(student->dept_id);
+
     printf(PIPE2 " BDCOM%03" PRIu32 " " PIPE2 " %*.*s " PIPE2 " %6s ", student->id,
-           STUDENT_NAME_SIZE, STUDENT_NAME_SIZE, student->name,
+           STUDENT_NAME_SIZE, STUDENT_NAME_SIZE, student_name(student),
            (student->gender == 'm') ? "Male" : "Female");
-    if (student->dept == NULL)
+    if (dept == NULL)
     {
         printf(PIPE2 " %*.*s ", DEPT_NAME_SIZE, DEPT_NAME_SIZE, "None");
     }
     else
     {
-        printf(PIPE2 " %*.*s ", DEPT_NAME_SIZE, DEPT_NAME_SIZE, student->dept->name);
+        printf(PIPE2 " %*.*s ", DEPT_NAME_SIZE, DEPT_NAME_SIZE, dept->name);
     }
-    if (student->grade == NULL)
+    if (student->grade_row == GRADE_NONE)
     {
         printf(PIPE2 "    None " PIPE2 "    None " PIPE2 "    None " PIPE2 "\n");
     }
     else
     {
-        printf(PIPE2 " %7" PRIu8 " ", student->grade->english);
-        printf(PIPE2 " %7" PRIu8 " ", student->grade->math);
-        printf(PIPE2 " %7" PRIu8 " " PIPE2 "\n", student->grade->history);
+        printf(PIPE2 " %7" PRIu8 " ", Grades.english[student->grade_row]);
+        printf(PIPE2 " %7" PRIu8 " ", Grades.math[student->grade_row]);
+        printf(PIPE2 " %7" PRIu8 " " PIPE2 "\n", Grades.history[student->grade_row]);
     }
     fflush(stdout);
     return;
 }
 
-void print_student()
+static void print_student_header()
 {
-    Student_t *student = NULL;
-    system("clear");
-
 #ifdef USE_UNICODE
     printf("┌──────────┬──────────────────────┬────────┬──────────────────────┬─────────┬─────────┬"
            "─────────┐\n");
@@ -344,16 +511,10 @@ void print_student()
     printf("+----------+----------------------+--------+----------------------+---------+---------+"
            "---------+\n");
 #endif
+}
 
-    sorted_student_init();
-    student = sorted_student_next();
-    while (student != NULL)
-    {
-        print_student_row(student);
-        student = sorted_student_next();
-    }
-    sorted_student_free();
-
+static void print_student_footer()
+{
 #ifdef USE_UNICODE
     printf("└──────────┴──────────────────────┴────────┴──────────────────────┴─────────┴─────────┴"
            "─────────┘\n");
@@ -361,134 +522,397 @@ void print_student()
     printf("+----------+----------------------+--------+----------------------+---------+---------+"
            "---------+\n");
 #endif
+}
+
+void print_student()
+{
+    Student_t **students = NULL;
+    size_t count = 0;
+    system("clear");
+
+    print_student_header();
+    if (sorted_students(&students, &count) == true)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            print_student_row(students[i]);
+        }
+    }
+    print_student_footer();
+    press_any_key();
+
+    return;
+}
+
+/****************************************************************************
+ * Name: print_student_range
+ * Input: None
+ * Return: None
+ * Description:
+ *   Asks for an ID range and lists the students inside it, inclusive.
+ *   The iterator seeks to the first ID by binary search in the sorted
+ *   view, so only the rows printed are visited.
+ ****************************************************************************/
+void print_student_range()
+{
+    uint32_t first = 0;
+    uint32_t last = 0;
+    StudentIter_t iter;
+    Student_t *student = NULL;
+    Student_t **students = NULL;
+    size_t count = 0;
+
+    first = get_int("First Student ID", INT_DEPT_LENGTH, NULL);
+    if (first == UINT32_MAX)
+    {
+        popup("Message", "Student ID not provided.", "OK");
+        return;
+    }
+    last = get_int("Last Student ID", INT_DEPT_LENGTH, NULL);
+    if (last == UINT32_MAX)
+    {
+        popup("Message", "Student ID not provided.", "OK");
+        return;
+    }
+    if (last < first)
+    {
+        popup("Error", "Last ID is smaller than the first.", "OK");
+        return;
+    }
+
+    /* rebuilds the view if a bulk change dropped it, so the seek is a binary search */
+    if (sorted_students(&students, &count) == false)
+    {
+        return;
+    }
+    if (student_iter_init(&iter, first, NULL, NULL) == false)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        press_any_key();
+        return;
+    }
+
+    system("clear");
+    print_student_header();
+    while ((student = student_iter_next(&iter)) != NULL && student->id <= last)
+    {
+        print_student_row(student);
+    }
+    print_student_footer();
+    student_iter_free(&iter);
     press_any_key();
 
     return;
 }
 
-void save_students(const char *filename)
+/*
+ * Fixed-width record: id, name length, name with terminating null, gender,
+ * dept id (UINT32_MAX for none).
+ * Compact record: varint id delta to the previous record, varint dept id + 1
+ * (0 for none), name length << 1 | 1 for female, name without null.
+ */
+static void put_student_record(DataWriter_t *writer, const Student_t *student, uint32_t *prev_id)
 {
-    FILE *file = NULL;
     uint8_t name_length = 0;
-    uint32_t dept_id = 0;
-    Student_t *current = NULL;
+    uint32_t dept_id = student->dept_id;
+    const char *name = student_name(student);
+
+    if (writer->flags & DATA_FLAG_COMPACT)
+    {
+        name_length = strnlen(name, STUDENT_NAME_SIZE - 1);
+        data_writer_put_varint(writer, student->id - *prev_id);
+        data_writer_put_varint(writer, dept_id + 1);
+        data_writer_put(writer, &(uint8_t){(name_length << 1) | (student->gender == 'f')}, 1);
+        data_writer_put(writer, name, name_length);
+        *prev_id = student->id;
+        return;
+    }
+
+    name_length = strnlen(name, STUDENT_NAME_SIZE - 1) + 1;
+    data_writer_put(writer, &student->id, sizeof(student->id));
+    data_writer_put(writer, &name_length, sizeof(name_length));
+    data_writer_put(writer, name, name_length);
+    data_writer_put(writer, &student->gender, sizeof(student->gender));
+    data_writer_put(writer, &dept_id, sizeof(dept_id));
+}
+
+static bool_t read_student_record(DataReader_t *reader, Student_t *student, uint32_t *dept_id,
+                                  const uint8_t **name, size_t *name_size, uint32_t *prev_id)
+{
+    uint8_t name_length = 0;
+    uint32_t delta = 0;
+
+    if (reader->header.flags & DATA_FLAG_COMPACT)
+    {
+        if (data_reader_read_varint(reader, &delta) == false ||
+            data_reader_read_varint(reader, dept_id) == false ||
+            data_reader_read(reader, &name_length, sizeof(name_length)) == false ||
+            (*name = data_reader_take(reader, name_length >> 1)) == NULL)
+        {
+            return false;
+        }
+        student->id = *prev_id + delta;
+        student->gender = (name_length & 1) ? 'f' : 'm';
+        *dept_id -= 1;
+        *name_size = (name_length >> 1) + 1;
+        *prev_id = student->id;
+        return true;
+    }
+
+    if (data_reader_read(reader, &student->id, sizeof(student->id)) == false ||
+        data_reader_read(reader, &name_length, sizeof(name_length)) == false ||
+        name_length == 0 || (*name = data_reader_take(reader, name_length)) == NULL ||
+        data_reader_read(reader, &student->gender, sizeof(student->gender)) == false ||
+        data_reader_read(reader, dept_id, sizeof(*dept_id)) == false)
+    {
+        return false;
+    }
+    *name_size = name_length;
+
+    return true;
+}
+
+bool_t save_students(const char *filename)
+{
+    DataWriter_t writer = {0};
+    uint32_t prev_id = 0;
+    Student_t **students = NULL;
+    size_t count = 0;
 
-    file = fopen(filename, "wb");
-    if (file == NULL)
+    if (data_writer_open(&writer, filename, STUDENT_FILE_MAGIC, SNAPSHOT_FLAGS) == false)
     {
         fprintf(stderr, "Error opening file for writing: %s\n", filename);
         press_any_key();
-        return;
+        return false;
+    }
+
+    if (sorted_students(&students, &count) == false)
+    {
+        data_writer_abort(&writer);
+        return false;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        put_student_record(&writer, students[i], &prev_id);
+    }
+
+    if (data_writer_commit(&writer, (uint32_t)count) == false)
+    {
+        fprintf(stderr, "Error writing to file: %s\n", filename);
+        press_any_key();
+        return false;
+    }
+
+    return true;
+}
+
+static int cmp_student_ptr(const void *a, const void *b)
+{
+    return compare_uint32((*(Student_t *const *)a)->id, (*(Student_t *const *)b)->id);
+}
+
+/****************************************************************************
+ * Name: link_loaded_students
+ * Input:
+ *   Student_t **students  Loaded students, not yet linked into any list.
+ *   size_t count          Number of students in the array.
+ * Return:
+ *   None
+ * Description:
+ *   Links the loaded students into Student_Head or their department list.
+ *   save_students() writes records in ascending ID order, so normally the
+ *   array is already sorted; otherwise it is sorted once here. Walking the
+ *   array backwards, each student is smaller than every student already
+ *   linked into its list and can be pushed at the front in O(1). Lists that
+ *   already held students fall back to insert_sorted(). The lanes of every
+ *   list are rebuilt at the end.
+ ****************************************************************************/
+static void link_loaded_students(Student_t **students, size_t count)
+{
+    ListNode_t **head = NULL;
+    Dept_t *dept = NULL;
+    bool_t sorted = true;
+
+    for (size_t i = 1; i < count && sorted; i++)
+    {
+        sorted = (students[i - 1]->id < students[i]->id);
+    }
+    if (sorted == false)
+    {
+        qsort(students, count, sizeof(Student_t *), &cmp_student_ptr);
     }
 
-    sorted_student_init();
-    current = sorted_student_next();
-    while (current != NULL)
+    for (size_t i = count; i-- > 0;)
     {
-        name_length = strnlen(current->name, STUDENT_NAME_SIZE - 1) + 1;
-        dept_id = (current->dept != NULL) ? current->dept->id : UINT32_MAX;
+        if (dept == NULL || dept->id != students[i]->dept_id)
+        {
+            dept = search_dept(students[i]->dept_id);
+        }
+        head = student_list(dept);
+        dept_stats_apply(dept, students[i], 1);
 
-        if (fwrite(&current->id, sizeof(current->id), 1, file) != 1 ||
-            fwrite(&name_length, sizeof(name_length), 1, file) != 1 ||
-            fwrite(current->name, sizeof(char), name_length, file) != name_length ||
-            fwrite(&current->gender, sizeof(current->gender), 1, file) != 1 ||
-            fwrite(&dept_id, sizeof(dept_id), 1, file) != 1)
+        if (*head != NULL && cmp_student((ListNode_t *)students[i], *head) > 0)
         {
-            fprintf(stderr, "Error writing to file: %s\n", filename);
-            press_any_key();
-            break;
+            insert_sorted(head, (ListNode_t *)students[i], &cmp_student);
+        }
+        else
+        {
+            insert_front(head, (ListNode_t *)students[i]);
         }
+    }
 
-        current = sorted_student_next();
+    skip_index_build(&Student_Head_Lanes, (ListNode_t *)Student_Head);
+    for (dept = Dept_Head; dept != NULL; dept = (Dept_t *)dept->node.next)
+    {
+        skip_index_build(&dept->student_lanes, (ListNode_t *)dept->students);
     }
-    sorted_student_free();
 
-    fclose(file);
     return;
 }
 
-void load_students(const char *filename)
+/****************************************************************************
+ * Name: parse_students
+ * Input:
+ *   const char *filename  Path of the student file.
+ * Return:
+ *   None
+ * Description:
+ *   Reads the students in `filename` into Parsed_Students, keyed by their
+ *   department ID. Neither the index nor any list is touched, so it may run
+ *   on a loader thread while the departments are still being parsed.
+ ****************************************************************************/
+void parse_students(const char *filename)
 {
-    FILE *file = NULL;
-    long file_length = 0;
-    Dept_t *dept = NULL;
+    DataReader_t *reader = &Parsed_Students.reader;
     uint32_t dept_id = 0;
-    uint8_t name_length = 0;
+    uint32_t prev_id = 0;
+    size_t name_size = 0;
+    const uint8_t *name = NULL;
     Student_t *new_student = NULL;
+    Student_t **slot = NULL;
 
-    file = fopen(filename, "rb");
-    if (file == NULL)
+    if (parsed_table_open(&Parsed_Students, filename, STUDENT_FILE_MAGIC, sizeof(Student_t *),
+                          STUDENT_MIN_RECORD_SIZE) == false)
     {
-        fprintf(stderr, "Error opening file for reading: %s\n", filename);
-        press_any_key();
         return;
     }
+    /* only hints: if they fail, the allocations below grow as needed and report running out */
+    pool_reserve(&Student_Pool, reader->header.record_count);
+    reserve_name_slots(Name_Slot_Count + reader->header.record_count);
 
-    fseek(file, 0, SEEK_END);
-    file_length = ftell(file);
-    fseek(file, 0, SEEK_SET);
-
-    while (ftell(file) < file_length)
+    while (data_reader_remaining(reader) > 0)
     {
-        new_student = (Student_t *)calloc(1, sizeof(Student_t));
+        new_student = (Student_t *)pool_alloc(&Student_Pool);
         if (new_student == NULL)
         {
-            fprintf(stderr, "Memory allocation failed\n");
-            press_any_key();
+            Parsed_Students.error = "Memory allocation failed";
             break;
         }
 
-        if (fread(&new_student->id, sizeof(new_student->id), 1, file) != 1 ||
-            fread(&name_length, sizeof(name_length), 1, file) != 1)
+        if (read_student_record(reader, new_student, &dept_id, &name, &name_size, &prev_id) ==
+            false)
         {
-            free(new_student);
-            fprintf(stderr, "Error reading student data from file: %s\n", filename);
-            press_any_key();
+            pool_free(&Student_Pool, new_student);
+            Parsed_Students.error = "Error reading student data from file";
             break;
         }
-        new_student->name = (char *)malloc(name_length);
-        if (new_student->name == NULL)
+        new_student->grade_row = GRADE_NONE;
+        new_student->dept_id = DEPT_NONE;
+
+        new_student->slot = alloc_name_slot();
+        slot = (new_student->slot != UINT32_MAX)
+                   ? (Student_t **)parsed_table_add(&Parsed_Students, dept_id)
+                   : NULL;
+        if (slot == NULL)
         {
-            free(new_student);
-            fprintf(stderr, "Memory allocation failed\n");
-            press_any_key();
+            if (new_student->slot != UINT32_MAX)
+            {
+                free_name_slot(new_student->slot);
+            }
+            pool_free(&Student_Pool, new_student);
+            Parsed_Students.error = "Memory allocation failed";
             break;
         }
+        string_copy(Student_Names[new_student->slot], (const char *)name,
+                    (name_size < STUDENT_NAME_SIZE) ? name_size : STUDENT_NAME_SIZE);
+        *slot = new_student;
+    }
+
+    data_reader_close(reader);
 
-        if (fread(new_student->name, sizeof(char), name_length, file) != name_length ||
-            fread(&new_student->gender, sizeof(new_student->gender), 1, file) != 1 ||
-            fread(&dept_id, sizeof(dept_id), 1, file) != 1)
+    return;
+}
+
+/****************************************************************************
+ * Name: link_students
+ * Input: None
+ * Return: None
+ * Description:
+ *   Indexes the students read by parse_students(), resolves their
+ *   departments and links them into the student lists. Must run after
+ *   link_depts(). Duplicate IDs are discarded.
+ ****************************************************************************/
+void link_students()
+{
+    Student_t *student = NULL;
+    Student_t **loaded = (Student_t **)Parsed_Students.records;
+    size_t loaded_count = 0;
+
+    if (Parsed_Students.error != NULL)
+    {
+        fprintf(stderr, "%s: %s\n", Parsed_Students.error, Parsed_Students.filename);
+        press_any_key();
+    }
+
+    if (hash_index_reserve(&Student_Index, Student_Index.count + Parsed_Students.count) == false)
+    {
+        fprintf(stderr, "Memory allocation failed\n");
+        press_any_key();
+    }
+
+    /* compacted in place, the array is reused as the list of linked students */
+    for (size_t i = 0; i < Parsed_Students.count; i++)
+    {
+        student = loaded[i];
+        if (search_student(student->id) != NULL)
         {
-            free(new_student->name);
-            free(new_student);
-            fprintf(stderr, "Error reading student data from file: %s\n", filename);
+            fprintf(stderr, "Student ID not unique, discarding.\n");
+            free_name_slot(student->slot);
+            pool_free(&Student_Pool, student);
             press_any_key();
-            break;
+            continue;
         }
-        new_student->name[name_length - 1] = '\0';
 
-        if (dept_id == UINT32_MAX)
-        {
-            dept = NULL;
-        }
-        else
+        if (hash_index_insert(&Student_Index, student->id, student) == false)
         {
-            dept = (Dept_t *)search_sorted(dept_id, &match_dept, (ListNode_t *)Dept_Head);
+            fprintf(stderr, "Memory allocation failed\n");
+            press_any_key();
+            for (; i < Parsed_Students.count; i++)
+            {
+                free_name_slot(loaded[i]->slot);
+                pool_free(&Student_Pool, loaded[i]);
+            }
+            break;
         }
 
-        new_student->dept = dept;
-
-        if (dept == NULL)
+        if (Parsed_Students.keys[i] != DEPT_NONE && search_dept(Parsed_Students.keys[i]) != NULL)
         {
-            insert_sorted((ListNode_t **)&Student_Head, (ListNode_t *)new_student, &cmp_student);
-        }
-        else
-        {
-            insert_sorted((ListNode_t **)&dept->students, (ListNode_t *)new_student, &cmp_student);
+            student->dept_id = Parsed_Students.keys[i];
         }
+
+        loaded[loaded_count++] = student;
     }
 
-    fclose(file);
+    link_loaded_students(loaded, loaded_count);
+    sorted_view_invalidate();
+    parsed_table_free(&Parsed_Students);
 
     return;
 }
+
+void load_students(const char *filename)
+{
+    parse_students(filename);
+    link_students();
+}
@@ -652,4 +652,31 @@ void press_any_key()
         usleep(10000);
     }
     return;
-}
\ No newline at end of file
+}
+
+/* columns of the terminal, 80 when the output is not a terminal */
+size_t terminal_width()
+{
+    struct winsize ws;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == -1 || ws.ws_col == 0)
+    {
+        return 80;
+    }
+    return ws.ws_col;
+}
+
+/* a bar of `filled` BAR cells padded with spaces to `width` cells */
+void print_bar(size_t filled, size_t width)
+{
+    size_t i = 0;
+
+    for (; i < filled && i < width; i++)
+    {
+        fputs(BAR, stdout);
+    }
+    for (; i < width; i++)
+    {
+        putchar(' ');
+    }
+}